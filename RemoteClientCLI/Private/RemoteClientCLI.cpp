@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RequiredProgramMainCPPInclude.h"
+#include "RemoteClientCore.h"
+#include "RemoteClientConnection.h"
+#include "RemoteClientLog.h"
+#include "RemoteMockServer.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogRemoteClientCLI, Log, All);
+
+IMPLEMENT_APPLICATION(RemoteClientCLI, "RemoteClientCLI");
+
+/*
+ * RemoteClientCLI -File=<log> [-Server=127.0.0.1 -Port=54817 -MCU=<name>] [-Speed=0 -Loops=1 -Window=1 -Binary -Shm]
+ *                 [-Mock + RemoteClient.MockServer settings]
+ * Streams a recorded movement log (see FRemoteClientRecorder) through a connection, as fast as it takes them at Speed=0.
+ * -Mock serves a mock MCU in process, -Loops=0 replays until interrupted (soak test). Exit code 0 = every order completed.
+ */
+
+static bool _WaitIdle(const FRemoteClientConnection& conn, double Timeout){
+    const double deadline=FPlatformTime::Seconds()+Timeout;
+    while(conn.HasPendingMovement() || conn.GetStatus()!=ECLIStatusCode::IDLE){
+        if(conn.GetErr()!=ECLIErrorCode::CLEAR || FPlatformTime::Seconds()>=deadline){
+            return false;
+        }
+        FPlatformProcess::SleepNoStats(0.001f);
+    }
+    return true;
+}
+
+static int32 _Run(const TCHAR* CmdLine){
+
+    FString path;
+    if(!FParse::Value(CmdLine, TEXT("File="), path)){
+        UE_LOG(LogRemoteClientCLI, Error, TEXT("-File=<movement log> is required"));
+        return 1;
+    }
+    path=FPaths::ConvertRelativePathToFull(FPaths::LaunchDir(), path);
+
+    float speed=0.f;
+    int32 loops=1;
+    FParse::Value(CmdLine, TEXT("Speed="), speed);
+    FParse::Value(CmdLine, TEXT("Loops="), loops);
+
+    FRemoteClientSettings settings;
+    settings.IpAdr=TEXT("127.0.0.1");
+    settings.Port=54817;
+    settings.bAutoReconnect=false;
+    settings.bWarmStart=false;
+    FParse::Value(CmdLine, TEXT("Server="), settings.IpAdr);
+    FParse::Value(CmdLine, TEXT("Port="), settings.Port);
+    FParse::Value(CmdLine, TEXT("MCU="), settings.mcuName);
+    FParse::Value(CmdLine, TEXT("Window="), settings.MaxInFlightOrders);
+    settings.MaxInFlightOrders=FMath::Clamp(settings.MaxInFlightOrders, 1, 16);
+    settings.bUseBinaryProtocol=FParse::Param(CmdLine, TEXT("Binary"));
+    settings.Transport=FParse::Param(CmdLine, TEXT("Shm")) ? ERemoteClientTransport::SharedMemory : ERemoteClientTransport::Tcp;
+
+#if !UE_BUILD_SHIPPING
+    TUniquePtr<FRemoteMockServer> mock;
+    if(FParse::Param(CmdLine, TEXT("Mock"))){
+        FRemoteMockServerSettings mockSettings;
+        mockSettings.Port=settings.Port;
+        FRemoteMockServer::ParseSettings(CmdLine, mockSettings);
+        mockSettings.bSharedMemory=settings.Transport==ERemoteClientTransport::SharedMemory;
+        mock=MakeUnique<FRemoteMockServer>(mockSettings);
+        if(!mock->Start()){
+            return 1;
+        }
+        settings.IpAdr=TEXT("127.0.0.1");
+        settings.mcuName=TEXT("Mock");
+    }
+#endif
+
+    FRemoteClientConnection conn;
+    TFuture<ECLIErrorCode> connected=conn.Connect(settings);
+    if(!connected.WaitFor(FTimespan::FromSeconds(settings.ConnectTimeoutS+1.0)) || connected.Get()!=ECLIErrorCode::CLEAR){
+        UE_LOG(LogRemoteClientCLI, Error, TEXT("Could not connect to %s:%d (%d)"), *settings.IpAdr, settings.Port, (int32)conn.GetErr());
+        return 1;
+    }
+
+    conn.GetStats().Reset();
+    const double start=FPlatformTime::Seconds();
+    int32 movements=0;
+    bool bOk=true;
+    for(int32 loop=0; bOk && (loops<=0 || loop<loops) && !IsEngineExitRequested(); loop++){
+        FRemoteClientReplayer replayer(conn);
+        if(!replayer.Start(path, speed)){
+            bOk=false;
+            break;
+        }
+        while(replayer.IsRunning() && !IsEngineExitRequested()){
+            FPlatformProcess::SleepNoStats(0.01f);
+        }
+        replayer.Stop();
+        movements+=replayer.GetReplayedMovements();
+        bOk=conn.GetErr()==ECLIErrorCode::CLEAR;
+    }
+    /* Let the last orders complete */
+    bOk=_WaitIdle(conn, settings.McuTimeoutS) && bOk;
+
+    const double elapsed=FPlatformTime::Seconds()-start;
+    const FRemoteClientStats& stats=conn.GetStats();
+    const FLatencyHistogram& order=stats.GetPhase(ERemoteClientPhase::Order);
+    UE_LOG(LogRemoteClientCLI, Display, TEXT("%d movements, %llu orders in %.2f s = %.1f orders/s, end-to-end p50 %.3f ms, p99 %.3f ms, p99.9 %.3f ms"),
+        movements, stats.GetOrdersCompleted(), elapsed, stats.GetOrdersCompleted()/FMath::Max(elapsed, 1e-9),
+        order.GetPercentileUs(50)/1000.0, order.GetPercentileUs(99)/1000.0, order.GetPercentileUs(99.9)/1000.0);
+    if(!bOk){
+        UE_LOG(LogRemoteClientCLI, Error, TEXT("Stopped on error %d"), (int32)conn.GetErr());
+    }
+
+    conn.Disconnect();
+    return bOk ? 0 : 1;
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+    const FString cmdLine=FCommandLine::BuildFromArgV(nullptr, ArgC, ArgV, nullptr);
+    if(GEngineLoop.PreInit(*cmdLine)!=0){
+        return 1;
+    }
+
+    const int32 result=_Run(*cmdLine);
+
+    FEngineLoop::AppPreExit();
+    FModuleManager::Get().UnloadModulesAtShutdown();
+    FEngineLoop::AppExit();
+    return result;
+}
@@ -0,0 +1,13 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class RemoteClientCLI: ModuleRules
+{
+	public RemoteClientCLI(ReadOnlyTargetRules Target): base(Target)
+	{
+		PublicIncludePathModuleNames.Add("Launch");
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "Core", "Projects", "RemoteClientCore" });
+	}
+}
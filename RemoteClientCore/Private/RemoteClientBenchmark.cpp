@@ -0,0 +1,301 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "RemoteClientBenchmark.h"
+#include "RemoteClientCore.h"
+#include "RemoteClientConnection.h"
+#include "RemoteMockServer.h"
+#include "RemoteClientLog.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "Templates/TypeCompatibleBytes.h"
+#include "Async/Async.h"
+#include "Misc/Paths.h"
+
+/**
+ * Forwards everything to the engine allocator and counts the allocations made by the watched threads.
+ * Installed as GMalloc once at module start up (-RemoteClientCountAllocs) and kept for the whole process: GMalloc is never
+ * swapped back while other threads allocate through it, and memory allocated before stays with the allocator it forwards to.
+ */
+class FAllocCountingMalloc final : public FMalloc
+{
+	public:
+
+		explicit FAllocCountingMalloc(FMalloc* InInner) : inner(InInner) {}
+
+		FMalloc* GetInner() const { return inner; }
+
+		void Watch(uint32 ThreadA, uint32 ThreadB){
+			allocs=0;
+			watchedA=ThreadA;
+			watchedB=ThreadB;
+		}
+		void Unwatch(){ watchedA=0; watchedB=0; }
+		uint64 GetAllocs() const { return allocs.load(std::memory_order_relaxed); }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override { _Count(); return inner->Malloc(Count, Alignment); }
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override { _Count(); return inner->TryMalloc(Count, Alignment); }
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override { _Count(); return inner->Realloc(Original, Count, Alignment); }
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override { _Count(); return inner->TryRealloc(Original, Count, Alignment); }
+		virtual void Free(void* Original) override { inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return inner->ValidateHeap(); }
+		virtual void UpdateStats() override { inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { inner->DumpAllocatorStats(Ar); }
+		virtual const TCHAR* GetDescriptiveName() override { return inner->GetDescriptiveName(); }
+
+	private:
+
+		FMalloc* inner;
+		std::atomic<uint64> allocs = 0;
+		std::atomic<uint32> watchedA = 0;
+		std::atomic<uint32> watchedB = 0;
+
+		void _Count(){
+			const uint32 id=FPlatformTLS::GetCurrentThreadId();
+			if(id==watchedA.load(std::memory_order_relaxed) || id==watchedB.load(std::memory_order_relaxed)){
+				allocs.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+};
+
+struct FBenchParams
+{
+	int32 Orders = 2000;
+	int32 Window = 1;
+	bool bBinary = false;
+	int32 ServosPerOrder = 0;      /* 0 = every servo */
+	int32 CoalesceUs = 0;
+	bool bAdaptive = false;
+	FRemoteMockServerSettings mock;
+};
+
+static std::atomic<bool> GBenchRunning = false;
+static FAllocCountingMalloc* GAllocCounter = nullptr;
+
+void RemoteClientBench::InstallAllocationCounter(){
+    if(GAllocCounter || !GMalloc){
+        return;
+    }
+    /* Static storage, never destroyed: frees can reach the wrapper until the very end of the process */
+    static TTypeCompatibleBytes<FAllocCountingMalloc> storage;
+    GAllocCounter=new(storage.GetTypedPtr()) FAllocCountingMalloc(GMalloc);
+    GMalloc=GAllocCounter;
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Bench: counting allocations through %s"), GAllocCounter->GetInner()->GetDescriptiveName());
+}
+
+/**
+ *  Closed loop run against a local mock server: the producer keeps rewriting every servo target, the connection sends
+ *  them as fast as the order window & the simulated MCU allow. End-to-end latency is SendMovement -> MCU ACK.
+ */
+static void _RunBench(const FBenchParams& params){
+
+    FRemoteMockServer server(params.mock);
+    if(!server.Start()){
+        return;
+    }
+
+    FRemoteClientSettings clientSettings;
+    clientSettings.IpAdr=TEXT("127.0.0.1");
+    clientSettings.Port=params.mock.Port;
+    clientSettings.mcuName=TEXT("Mock");
+    clientSettings.MaxInFlightOrders=params.Window;
+    clientSettings.bUseBinaryProtocol=params.bBinary;
+    clientSettings.Transport=params.mock.bSharedMemory ? ERemoteClientTransport::SharedMemory : ERemoteClientTransport::Tcp;
+    clientSettings.CoalesceWindowUs=params.CoalesceUs;
+    clientSettings.bAdaptiveCoalescing=params.bAdaptive;
+
+    FRemoteClientConnection conn;
+    TFuture<ECLIErrorCode> connected=conn.Connect(clientSettings);
+    if(!connected.WaitFor(FTimespan::FromSeconds(5.0)) || connected.Get()!=ECLIErrorCode::CLEAR){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Bench: mock server start up failed (%d)"), (int32)conn.GetErr());
+        return;
+    }
+
+    const int32 servoCount=params.ServosPerOrder>0 ? FMath::Min<int32>(params.ServosPerOrder, params.mock.ServoCount) : params.mock.ServoCount;
+    FServoInfo movements[MAX_SERVOS];
+
+    conn.GetStats().Reset();
+    if(GAllocCounter){
+        GAllocCounter->Watch(FPlatformTLS::GetCurrentThreadId(), conn.GetThreadId());
+    }
+
+    const double start=FPlatformTime::Seconds();
+    const double deadline=start+120.0;
+    uint32 step=0;
+    int32 recoveries=0;
+    while(conn.GetStats().GetOrdersCompleted()<(uint64)params.Orders && FPlatformTime::Seconds()<deadline){
+        if(conn.GetErr()!=ECLIErrorCode::CLEAR){
+            /* Injected NACK, the window was dropped */
+            conn.ClearErr().Wait();
+            recoveries++;
+        }
+        step++;
+        for(int32 i=0; i<servoCount; i++){
+            movements[i]=FServoInfo(i, (step+i*7)%180);
+        }
+        conn.SendMovement(TArrayView<const FServoInfo>(movements, servoCount));
+        FPlatformProcess::SleepNoStats(0.00005f);
+    }
+
+    const double elapsed=FPlatformTime::Seconds()-start;
+    if(GAllocCounter){
+        GAllocCounter->Unwatch();
+    }
+
+    const FRemoteClientStats& stats=conn.GetStats();
+    const FLatencyHistogram& order=stats.GetPhase(ERemoteClientPhase::Order);
+    const uint64 completed=stats.GetOrdersCompleted();
+
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Bench: %s protocol over %s, window %d, %d servos/order, MCU %.1f+-%.1f ms, %.1f%% NACK, %d byte segments, %s coalescing %d us"),
+        params.bBinary ? TEXT("binary") : TEXT("text"), params.mock.bSharedMemory ? TEXT("shared memory") : TEXT("TCP"), params.Window, servoCount, params.mock.McuLatencyMs, params.mock.McuJitterMs,
+        params.mock.NackPercent, params.mock.SegmentBytes, params.bAdaptive ? TEXT("adaptive") : TEXT("fixed"), params.CoalesceUs);
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Bench: %llu orders in %.2f s = %.1f orders/s, %d NACK recoveries"),
+        completed, elapsed, completed/FMath::Max(elapsed, 1e-9), recoveries);
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Bench: end-to-end p50 %.3f ms, p99 %.3f ms, p99.9 %.3f ms | server ACK p50 %.3f ms"),
+        order.GetPercentileUs(50)/1000.0, order.GetPercentileUs(99)/1000.0, order.GetPercentileUs(99.9)/1000.0,
+        stats.GetPhase(ERemoteClientPhase::ServerAck).GetPercentileUs(50)/1000.0);
+    if(GAllocCounter){
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Bench: %.2f allocations per order (producer + connection thread)"),
+            completed>0 ? (double)GAllocCounter->GetAllocs()/completed : 0.0);
+    }else{
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Bench: allocations not counted, start with -RemoteClientCountAllocs"));
+    }
+
+    conn.Disconnect();
+}
+
+/* Console: RemoteClient.Bench [Orders=2000 Window=1 Binary=0 ServosPerOrder=0 Coalesce=0 Adaptive=0] + RemoteClient.MockServer settings (default port 54899) */
+
+static void _BenchCommand(const TArray<FString>& Args){
+
+    if(GBenchRunning.exchange(true)){
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Bench: already running"));
+        return;
+    }
+
+    const FString cmdLine=FString::Join(Args, TEXT(" "));
+    FBenchParams params;
+    params.mock.Port=54899;
+    FParse::Value(*cmdLine, TEXT("Orders="), params.Orders);
+    FParse::Value(*cmdLine, TEXT("Window="), params.Window);
+    FParse::Bool(*cmdLine, TEXT("Binary="), params.bBinary);
+    FParse::Value(*cmdLine, TEXT("ServosPerOrder="), params.ServosPerOrder);
+    FParse::Value(*cmdLine, TEXT("Coalesce="), params.CoalesceUs);
+    FParse::Bool(*cmdLine, TEXT("Adaptive="), params.bAdaptive);
+    FRemoteMockServer::ParseSettings(*cmdLine, params.mock);
+    params.Window=FMath::Clamp(params.Window, 1, 16);
+
+    /* Off the game thread, the run takes seconds */
+    Async(EAsyncExecution::Thread, [params](){
+        _RunBench(params);
+        GBenchRunning=false;
+    });
+}
+
+static FAutoConsoleCommand GBenchCmd(
+    TEXT("RemoteClient.Bench"),
+    TEXT("Runs a throughput/latency benchmark against a local mock server: Orders= Window= Binary=0/1 ServosPerOrder= Coalesce=us Adaptive=0/1 plus the RemoteClient.MockServer settings"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&_BenchCommand));
+
+/** Regression load test: a recorded session is replayed against the mock server, latencies are reported like the bench */
+static void _RunReplay(const FString& path, float speed, bool bBinary, int32 window, const FRemoteMockServerSettings& mock){
+
+    FRemoteMockServer server(mock);
+    if(!server.Start()){
+        return;
+    }
+
+    FRemoteClientSettings clientSettings;
+    clientSettings.IpAdr=TEXT("127.0.0.1");
+    clientSettings.Port=mock.Port;
+    clientSettings.mcuName=TEXT("Mock");
+    clientSettings.MaxInFlightOrders=window;
+    clientSettings.bUseBinaryProtocol=bBinary;
+    clientSettings.Transport=mock.bSharedMemory ? ERemoteClientTransport::SharedMemory : ERemoteClientTransport::Tcp;
+
+    FRemoteClientConnection conn;
+    TFuture<ECLIErrorCode> connected=conn.Connect(clientSettings);
+    if(!connected.WaitFor(FTimespan::FromSeconds(5.0)) || connected.Get()!=ECLIErrorCode::CLEAR){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Replay: mock server start up failed (%d)"), (int32)conn.GetErr());
+        return;
+    }
+
+    conn.GetStats().Reset();
+    const double start=FPlatformTime::Seconds();
+    {
+        FRemoteClientReplayer replayer(conn);
+        if(!replayer.Start(path, speed)){
+            conn.Disconnect();
+            return;
+        }
+        while(replayer.IsRunning()){
+            FPlatformProcess::SleepNoStats(0.01f);
+        }
+    }
+    /* Let the last orders complete */
+    const double drainDeadline=FPlatformTime::Seconds()+5.0;
+    while((conn.HasPendingMovement() || conn.GetStatus()!=ECLIStatusCode::IDLE) && FPlatformTime::Seconds()<drainDeadline){
+        FPlatformProcess::SleepNoStats(0.001f);
+    }
+
+    const double elapsed=FPlatformTime::Seconds()-start;
+    const FRemoteClientStats& stats=conn.GetStats();
+    const FLatencyHistogram& order=stats.GetPhase(ERemoteClientPhase::Order);
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Replay: %llu orders in %.2f s = %.1f orders/s, end-to-end p50 %.3f ms, p99 %.3f ms, p99.9 %.3f ms"),
+        stats.GetOrdersCompleted(), elapsed, stats.GetOrdersCompleted()/FMath::Max(elapsed, 1e-9),
+        order.GetPercentileUs(50)/1000.0, order.GetPercentileUs(99)/1000.0, order.GetPercentileUs(99.9)/1000.0);
+
+    conn.Disconnect();
+}
+
+/* Console: RemoteClient.Replay File=<log> [Speed=0 Window=1 Binary=0] + RemoteClient.MockServer settings (default port 54899) */
+
+static void _ReplayCommand(const TArray<FString>& Args){
+
+    const FString cmdLine=FString::Join(Args, TEXT(" "));
+    FString path;
+    if(!FParse::Value(*cmdLine, TEXT("File="), path)){
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Replay: File= is required"));
+        return;
+    }
+    if(FPaths::IsRelative(path)){
+        path=FPaths::ProjectSavedDir()/TEXT("RemoteClient")/path;
+    }
+    if(GBenchRunning.exchange(true)){
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Replay: a bench is already running"));
+        return;
+    }
+
+    float speed=0.f;
+    int32 window=1;
+    bool bBinary=false;
+    FRemoteMockServerSettings mock;
+    mock.Port=54899;
+    FParse::Value(*cmdLine, TEXT("Speed="), speed);
+    FParse::Value(*cmdLine, TEXT("Window="), window);
+    FParse::Bool(*cmdLine, TEXT("Binary="), bBinary);
+    FRemoteMockServer::ParseSettings(*cmdLine, mock);
+    window=FMath::Clamp(window, 1, 16);
+
+    Async(EAsyncExecution::Thread, [path, speed, bBinary, window, mock](){
+        _RunReplay(path, speed, bBinary, window, mock);
+        GBenchRunning=false;
+    });
+}
+
+static FAutoConsoleCommand GReplayCmd(
+    TEXT("RemoteClient.Replay"),
+    TEXT("Replays a recorded command stream log against a local mock server: File= Speed=0 (as fast as possible)/1 (recorded pace) Window= Binary=0/1 plus the RemoteClient.MockServer settings"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&_ReplayCommand));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,1912 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteClientConnection.h"
+#include "RemoteClientCore.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+#include "IPAddress.h"
+#include "RemoteClientProtocol.h"
+#include "RemoteClientLog.h"
+#include "RemoteMCUInfoCache.h"
+#include "ServoLanes.h"
+
+
+constexpr uint32 IDLE_WAIT_MS = 10;       /* Nothing expected from the server, sleep until a command arrives */
+constexpr int64 REPLY_POLL_US = 500;      /* Waiting for replies, max latency to pick up new movements */
+constexpr float RECONNECT_MIN_DELAY_S = 0.25f;
+
+FRemoteClientConnection::FRemoteClientConnection(TFunction<void()> OnServosMoved)
+    : reconnectJitter((int32)FPlatformTime::Cycles())
+    , onServosMoved(MoveTemp(OnServosMoved))
+{
+    FMemory::Memzero(commanded);
+    /* Sized once for a full order window plus a control frame, frames are then written in place (FFrameWriter) */
+    outBuffer.Reserve(16*FRemoteClientProtocol::MAX_MOVEMENT_FRAME_LEN+FRemoteClientProtocol::MAX_FRAME_LEN);
+    datagram.Reserve(FRemoteClientProtocol::MAX_FRAME_LEN);
+    wakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    thread = FRunnableThread::Create(this, TEXT("RemoteClientConnection"), 0, TPri_AboveNormal);
+}
+
+FRemoteClientConnection::~FRemoteClientConnection(){
+    if(thread){
+        thread->Kill(true); /* Calls Stop() & waits for Run() to return */
+        delete thread;
+        thread = nullptr;
+    }
+    _SettleAll();
+    FPlatformProcess::ReturnSynchEventToPool(wakeEvent);
+    wakeEvent = nullptr;
+}
+
+uint32 FRemoteClientConnection::GetThreadId() const{
+    return thread ? thread->GetThreadID() : 0;
+}
+
+void FRemoteClientConnection::Stop(){
+    stopping=true;
+    wakeEvent->Trigger();
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::Connect(const FRemoteClientSettings& Settings){
+    FCommand cmd{ECommand::Connect, FString(), Settings};
+    cmd.promise=MakeUnique<TPromise<ECLIErrorCode>>();
+    TFuture<ECLIErrorCode> result=cmd.promise->GetFuture();
+    commands.Enqueue(MoveTemp(cmd));
+    wakeEvent->Trigger();
+    return result;
+}
+
+void FRemoteClientConnection::Disconnect(){
+    commands.Enqueue(FCommand{ECommand::Disconnect, FString(), FRemoteClientSettings()});
+    wakeEvent->Trigger();
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::SelectMCU(const FString& MCU_Name){
+    FCommand cmd{ECommand::SelectMCU, MCU_Name, FRemoteClientSettings()};
+    cmd.promise=MakeUnique<TPromise<ECLIErrorCode>>();
+    TFuture<ECLIErrorCode> result=cmd.promise->GetFuture();
+    commands.Enqueue(MoveTemp(cmd));
+    wakeEvent->Trigger();
+    return result;
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::RetrieveMCUInfo(){
+    FCommand cmd{ECommand::RetrieveMCUInfo, FString(), FRemoteClientSettings()};
+    cmd.promise=MakeUnique<TPromise<ECLIErrorCode>>();
+    TFuture<ECLIErrorCode> result=cmd.promise->GetFuture();
+    commands.Enqueue(MoveTemp(cmd));
+    wakeEvent->Trigger();
+    return result;
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::ClearErr(){
+    FCommand cmd{ECommand::ClearErr, FString(), FRemoteClientSettings()};
+    cmd.promise=MakeUnique<TPromise<ECLIErrorCode>>();
+    TFuture<ECLIErrorCode> result=cmd.promise->GetFuture();
+    commands.Enqueue(MoveTemp(cmd));
+    wakeEvent->Trigger();
+    return result;
+}
+
+void FRemoteClientConnection::StartStreaming(float RateHz, bool bUseUDP){
+    commands.Enqueue(FCommand{ECommand::StartStreaming, FString(), FRemoteClientSettings(), RateHz, bUseUDP});
+    wakeEvent->Trigger();
+}
+
+void FRemoteClientConnection::StopStreaming(){
+    commands.Enqueue(FCommand{ECommand::StopStreaming, FString(), FRemoteClientSettings()});
+    wakeEvent->Trigger();
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::SubscribeTelemetry(float RateHz){
+    FCommand cmd{ECommand::SubscribeTelemetry, FString(), FRemoteClientSettings(), RateHz};
+    cmd.promise=MakeUnique<TPromise<ECLIErrorCode>>();
+    TFuture<ECLIErrorCode> result=cmd.promise->GetFuture();
+    commands.Enqueue(MoveTemp(cmd));
+    wakeEvent->Trigger();
+    return result;
+}
+
+bool FRemoteClientConnection::SendMovement(TArrayView<const FServoInfo> servoMovements){
+    return _QueueMovement(servoMovements)!=0;
+}
+
+bool FRemoteClientConnection::SendMovement(uint32 mask, const uint8 (&positions)[MAX_SERVOS]){
+    return _QueueMovement(mask, positions)!=0;
+}
+
+bool FRemoteClientConnection::SendWireMovement(uint32 mask, const uint8 (&wirePositions)[MAX_SERVOS]){
+    return _QueueWire(mask, wirePositions)!=0;
+}
+
+/* queueingWaiters covers the gap between the ticket & its waiter, see _SettleMovements */
+TFuture<ECLIErrorCode> FRemoteClientConnection::SendMovementAsync(TArrayView<const FServoInfo> servoMovements){
+    queueingWaiters.fetch_add(1);
+    TFuture<ECLIErrorCode> result=_WaitForMovement(_QueueMovement(servoMovements));
+    queueingWaiters.fetch_sub(1);
+    return result;
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::SendMovementAsync(uint32 mask, const uint8 (&positions)[MAX_SERVOS]){
+    queueingWaiters.fetch_add(1);
+    TFuture<ECLIErrorCode> result=_WaitForMovement(_QueueMovement(mask, positions));
+    queueingWaiters.fetch_sub(1);
+    return result;
+}
+
+void FRemoteClientConnection::SetServoLimits(const uint8 (&MinPositions)[MAX_SERVOS], const uint8 (&MaxPositions)[MAX_SERVOS]){
+    uint8 minWire[MAX_SERVOS];
+    uint8 maxWire[MAX_SERVOS];
+    ServoLanes::AddEach(MinPositions, 1, minWire);
+    ServoLanes::AddEach(MaxPositions, 1, maxWire);
+    servos.SetLimits(minWire, maxWire);
+}
+
+void FRemoteClientConnection::GetServoLimits(uint8 (&OutMin)[MAX_SERVOS], uint8 (&OutMax)[MAX_SERVOS]) const{
+    servos.GetLimits(OutMin, OutMax);
+    for(auto i=0; i<MAX_SERVOS; i++){
+        OutMin[i]--;
+        OutMax[i]--;
+    }
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::_WaitForMovement(uint64 ticket){
+    if(ticket==0){
+        return MakeFulfilledPromise<ECLIErrorCode>(errCode.load()).GetFuture();
+    }
+    FMovementWaiter waiter{ticket};
+    TFuture<ECLIErrorCode> result=waiter.promise.GetFuture();
+    newMovementWaiters.Enqueue(MoveTemp(waiter));
+    wakeEvent->Trigger();
+    return result;
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::SendPriorityMovement(TArrayView<const FServoInfo> servoMovements, bool bCancelPending){
+
+    /* Refused without raising the sticky error: a stop has to go through whatever happened before */
+    const uint8 count=servos.GetServoCount();
+    for (auto &&mv : servoMovements){
+        if(mv.servoID>=count){
+            return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::INVALID_SERVO_ID).GetFuture();
+        }
+        if(mv.servoPosition>=180){
+            return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::INVALID_SERVO_POSITION).GetFuture();
+        }
+    }
+    if(servoMovements.Num()==0 && !bCancelPending){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::CLEAR).GetFuture();
+    }
+
+    uint8 wire[MAX_SERVOS]={};
+    uint32 mask=0;
+    for (auto &&mv : servoMovements){
+        wire[mv.servoID]=1+mv.servoPosition;
+        mask|=1u<<mv.servoID;
+    }
+    const ERemoteClientLimitMode mode=limitMode.load(std::memory_order_relaxed);
+    if(mode==ERemoteClientLimitMode::Reject && servos.FindOutOfLimits(wire, mask)!=0){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::INVALID_SERVO_POSITION).GetFuture();
+    }
+
+    FPriorityMovement movement;
+    if(mode==ERemoteClientLimitMode::Clamp){
+        servos.ClampToLimits(wire, movement.positions);
+    }else{
+        FMemory::Memcpy(movement.positions, wire, sizeof(wire));
+    }
+    movement.mask=mask;
+    movement.bCancelPending=bCancelPending;
+    return _QueuePriority(MoveTemp(movement));
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::HoldPosition(){
+    if(servos.GetServoCount()==0){
+        /* No iMCU yet: there is no current position to hold, an empty SRVU would only look like a stop */
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::StaleMCUInfo).GetFuture();
+    }
+    FPriorityMovement movement;
+    movement.bCancelPending=true;
+    movement.bHold=true;
+    return _QueuePriority(MoveTemp(movement));
+}
+
+TFuture<ECLIErrorCode> FRemoteClientConnection::_QueuePriority(FPriorityMovement&& movement){
+    movement.queuedCycles=FPlatformTime::Cycles64();
+    TFuture<ECLIErrorCode> result=movement.promise.GetFuture();
+    priorityMovements.Enqueue(MoveTemp(movement));
+    wakeEvent->Trigger();
+    return result;
+}
+
+/** Returns the ticket of the movement, 0 if it was refused */
+uint64 FRemoteClientConnection::_QueueMovement(TArrayView<const FServoInfo> servoMovements){
+
+    /* Check that system is not errored */
+    if(err.load()){
+        return 0;
+    }
+
+    /* Scattered into slots, last write of the batch wins. Ids are checked on the way, positions all at once afterwards */
+    uint8 positions[MAX_SERVOS]={};
+    uint32 mask=0;
+    for (auto &&mv : servoMovements){
+        if(mv.servoID>=MAX_SERVOS){
+            err=true;
+            errCode=ECLIErrorCode::INVALID_SERVO_ID;
+            return 0;
+        }
+        positions[mv.servoID]=mv.servoPosition;
+        mask|=1u<<mv.servoID;
+    }
+    return _QueueMovement(mask, positions);
+}
+
+uint64 FRemoteClientConnection::_QueueMovement(uint32 mask, const uint8 (&positions)[MAX_SERVOS]){
+    /* Add +1 offset here, the wire uses 1-180 */
+    uint8 wire[MAX_SERVOS];
+    ServoLanes::AddEach(positions, 1, wire);
+    return _QueueWire(mask, wire);
+}
+
+uint64 FRemoteClientConnection::_QueueWire(uint32 mask, const uint8 (&wire)[MAX_SERVOS]){
+
+    /* Check that system is not errored */
+    if(err.load()){
+        return 0;
+    }
+
+    /* Validate movement ids & positions */
+    const uint8 count=servos.GetServoCount();
+    if(count<MAX_SERVOS && (mask>>count)!=0){
+        err=true;
+        errCode=ECLIErrorCode::INVALID_SERVO_ID;
+        return 0;
+    }
+    /* Refused here rather than NACKed by the server a round trip later. Clamping still refuses targets off the wire range */
+    const ERemoteClientLimitMode mode=limitMode.load(std::memory_order_relaxed);
+    const uint32 outside=mode==ERemoteClientLimitMode::Reject ? servos.FindOutOfLimits(wire, mask) : FServoStateTable::FindOutOfRange(wire, mask);
+    if(outside!=0){
+        err=true;
+        errCode=ECLIErrorCode::INVALID_SERVO_POSITION;
+        return 0;
+    }
+    uint8 clamped[MAX_SERVOS];
+    if(mode==ERemoteClientLimitMode::Clamp){
+        servos.ClampToLimits(wire, clamped);
+    }
+
+    /* Add movements to the pending slots, overriding old values */
+    const uint32 coalesced=servos.SetPending(mode==ERemoteClientLimitMode::Clamp ? clamped : wire, mask);
+    stats.RecordWrites(FMath::CountBits(mask), FMath::CountBits(coalesced));
+    /* After the targets are pending, an order built from a ticket read before TakePending carries every movement up to it */
+    const uint64 ticket=movementTicket.fetch_add(1, std::memory_order_release)+1;
+    wakeEvent->Trigger();
+    return ticket;
+}
+
+void FRemoteClientConnection::PlayTrajectory(TArrayView<const FServoKeyframe> Keyframes, ETrajectoryInterpolation Interpolation, bool bAppend, float RateHz){
+
+    /* Check that system is not errored */
+    if(err.load() || Keyframes.Num()==0){
+        return;
+    }
+
+    /* Validate keyframe ids & positions, like SendMovement */
+    const uint8 count=servos.GetServoCount();
+    for (auto &&k : Keyframes){
+        if(k.servoID>=count){
+            err=true;
+            errCode=ECLIErrorCode::INVALID_SERVO_ID;
+            return;
+        }
+        if(k.servoPosition>=180){
+            err=true;
+            errCode=ECLIErrorCode::INVALID_SERVO_POSITION;
+            return;
+        }
+    }
+
+    FCommand cmd{ECommand::PlayTrajectory, FString(), FRemoteClientSettings(), RateHz, bAppend};
+    cmd.keyframes=TArray<FServoKeyframe>(Keyframes.GetData(), Keyframes.Num());
+    cmd.interpolation=Interpolation;
+    trajectoryPlaying=true;
+    commands.Enqueue(MoveTemp(cmd));
+    wakeEvent->Trigger();
+}
+
+void FRemoteClientConnection::StopTrajectory(){
+    commands.Enqueue(FCommand{ECommand::StopTrajectory, FString(), FRemoteClientSettings()});
+    wakeEvent->Trigger();
+}
+
+void FRemoteClientConnection::SetRecorder(TSharedPtr<FRemoteClientRecorder, ESPMode::ThreadSafe> Recorder){
+    FCommand cmd{ECommand::SetRecorder, FString(), FRemoteClientSettings()};
+    cmd.recorder=MoveTemp(Recorder);
+    commands.Enqueue(MoveTemp(cmd));
+    wakeEvent->Trigger();
+}
+
+uint32 FRemoteClientConnection::Run(){
+
+    while(!stopping.load()){
+
+        /* Commands wait in the queue while a query is being answered, so they never interleave on the socket. Local ones never wait */
+        FCommand* cmd;
+        while((cmd=commands.Peek())!=nullptr){
+            const bool bLocal=cmd->type==ECommand::ClearErr||cmd->type==ECommand::PlayTrajectory||cmd->type==ECommand::StopTrajectory
+                ||cmd->type==ECommand::SetRecorder;
+            if(_IsBusy() && !bLocal){
+                break;
+            }
+            FCommand next;
+            commands.Dequeue(next);
+            _Execute(next);
+        }
+
+        if(reconnectAt>0 && FPlatformTime::Seconds()>=reconnectAt){
+            /* Back to the MCU that was in use, its servo state is refreshed by the iMCU of the start up */
+            reconnectAt=0;
+            if(!selectedMCU.IsEmpty()){
+                settings.mcuName=selectedMCU;
+            }
+            _OpenConnection();
+        }
+        _CheckTimeouts();
+
+        _SendPriorityMovements();
+        _TrajectoryTick();
+        _SendPendingMovements();
+        _StreamTick();
+        _Poll();
+
+        _SettleQuery();
+        _SettleMovements();
+    }
+
+    _CloseConnection();
+    status=ECLIStatusCode::NO_SERVER_CONN;
+    return 0;
+}
+
+bool FRemoteClientConnection::_IsBusy() const{
+    /* Pipelined answers still on their way, even after a failure: nothing may be sent in between */
+    return (!err.load() && _IsReplyExpected()) || protocolQueued || discardReplies>0;
+}
+
+bool FRemoteClientConnection::_IsReplyExpected() const{
+    switch(status.load()){
+        case ECLIStatusCode::NEGOTIATING_PROTOCOL:
+        case ECLIStatusCode::ON_MCU_SELECT:
+        case ECLIStatusCode::RETRIEVING_INFO_sMCU:
+        case ECLIStatusCode::RETRIEVING_INFO:
+        case ECLIStatusCode::WAITING_SERVER_ACK:
+        case ECLIStatusCode::WAITING_MCU_ACK:
+        case ECLIStatusCode::SWITCHING_RT_MODE:
+        case ECLIStatusCode::SWITCHING_TELEMETRY:
+        case ECLIStatusCode::RETRIEVING_LIMITS:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void FRemoteClientConnection::_Execute(FCommand& cmd){
+
+    switch(cmd.type){
+
+        case ECommand::Connect:
+            if(status.load()!=ECLIStatusCode::STARTING_UP&&status.load()!=ECLIStatusCode::NO_SERVER_CONN){
+                /* Already connected (or connecting) */
+                _Reject(cmd, err.load() ? errCode.load() : status.load()==ECLIStatusCode::CONNECTING ? ECLIErrorCode::GenericError : ECLIErrorCode::CLEAR);
+                return;
+            }
+            settings=cmd.settings;
+            limitMode=settings.LimitMode;
+            reconnectAt=0;
+            reconnectDelay=0;
+            queryPromise=MoveTemp(cmd.promise);
+            _WarmStart();
+            _OpenConnection();
+            break;
+
+        case ECommand::Disconnect:
+            reconnectAt=0;
+            if(status.load()==ECLIStatusCode::NO_SERVER_CONN){
+                return;
+            }
+            status=ECLIStatusCode::NO_SERVER_CONN;
+            _CloseConnection();
+            _FailMovements(ECLIErrorCode::NoServerConnection);
+            break;
+
+        case ECommand::SelectMCU:
+            if(err.load()||(status.load()!=ECLIStatusCode::IDLE&&status.load()!=ECLIStatusCode::STARTING_UP)){
+                _Reject(cmd, err.load() ? errCode.load() : ECLIErrorCode::GenericError);
+                return;
+            }
+            startupCycles=0;
+            queryPromise=MoveTemp(cmd.promise);
+            _StartSelectMCU(cmd.arg);
+            break;
+
+        case ECommand::RetrieveMCUInfo:
+            if(err.load()||status.load()!=ECLIStatusCode::IDLE){
+                _Reject(cmd, err.load() ? errCode.load() : ECLIErrorCode::GenericError);
+                return;
+            }
+            startupCycles=0;
+            queryPromise=MoveTemp(cmd.promise);
+            _StartRetrieveMCUInfo();
+            break;
+
+        case ECommand::ClearErr:
+        {
+            /* Cleared here, in order with the failures: a movement queued after it is never failed by an earlier one */
+            const ECLIStatusCode s=status.load();
+            if(s!=ECLIStatusCode::STARTING_UP && s!=ECLIStatusCode::NO_SERVER_CONN && s!=ECLIStatusCode::CONNECTING){
+                err=false;
+                errCode=ECLIErrorCode::CLEAR;
+                if(s!=ECLIStatusCode::STREAMING){    /* Else the server is still in real time mode */
+                    inFlightOrders.Empty();
+                    status=ECLIStatusCode::IDLE;
+                }
+            }
+            _Reject(cmd, err.load() ? errCode.load() : ECLIErrorCode::CLEAR);
+            break;
+        }
+
+        case ECommand::StartStreaming:
+            if(err.load()||status.load()!=ECLIStatusCode::IDLE){
+                UE_LOG(LogRemoteClientSystem, Warning, TEXT("Streaming can only start from idle status"));
+                return;
+            }
+            _StartStreaming(cmd.value, cmd.bFlag);
+            break;
+
+        case ECommand::PlayTrajectory:
+        {
+            /* Tracks start from the current positions, or from the targets being played */
+            FServoPositionSnapshot current;
+            servos.ReadSnapshot(current);
+            const double now=FPlatformTime::Seconds();
+            if(!trajectory.IsActive()){
+                nextTrajectoryTick=now;
+            }
+            trajectoryPeriod=1.0/FMath::Clamp(cmd.value, 1.f, 1000.f);
+            trajectory.Load(cmd.keyframes, cmd.interpolation, cmd.bFlag, now, current.positions);
+            trajectoryPlaying=trajectory.IsActive();
+            break;
+        }
+
+        case ECommand::StopTrajectory:
+            trajectory.Clear();
+            trajectoryPlaying=false;
+            break;
+
+        case ECommand::SetRecorder:
+            /* The previous recorder flushes & closes its log once the last reference is dropped */
+            recorder=MoveTemp(cmd.recorder);
+            break;
+
+        case ECommand::SubscribeTelemetry:
+            if(err.load()||status.load()!=ECLIStatusCode::IDLE){
+                _Reject(cmd, err.load() ? errCode.load() : ECLIErrorCode::GenericError);
+                return;
+            }
+            telemetryRateHz=(uint16)FMath::Clamp(FMath::RoundToInt(cmd.value), 0, 1000);
+            queryPromise=MoveTemp(cmd.promise);
+            _StartTelemetry();
+            break;
+
+        case ECommand::StopStreaming:
+            if(status.load()!=ECLIStatusCode::STREAMING){
+                return;
+            }
+            streamOn=false;
+            FRemoteClientProtocol::AppendRealTimeMode(outBuffer, protocol, false);
+            _FlushSend();
+            _ArmReplyTimeout();
+            status=ECLIStatusCode::SWITCHING_RT_MODE;
+            break;
+    }
+}
+
+void FRemoteClientConnection::_OpenConnection(){
+
+    transport=IRemoteClientTransport::Create(settings.Transport);
+    protocol=EWireProtocol::Text;
+    sequencedOrders=false;
+    decoder.Reset();
+    outBuffer.Reset();
+    inFlightOrders.Empty();
+    telemetryOn=false;
+    limitsRetrieved=false;
+    infoQueued=false;
+    protocolQueued=false;
+    discardReplies=0;
+
+    startupCycles=FPlatformTime::Cycles64();
+    if(!transport->Connect(settings.IpAdr, settings.Port)){
+        _ConnectionLost(ECLIErrorCode::NoServerConnection);
+        return;
+    }
+    connectDeadline=FPlatformTime::Seconds()+settings.ConnectTimeoutS;
+    status=ECLIStatusCode::CONNECTING;
+}
+
+/** Waits for the connect in progress, without holding the thread longer than a reply poll */
+void FRemoteClientConnection::_PollConnect(){
+
+    switch(transport->PollConnect(FTimespan::FromMicroseconds(REPLY_POLL_US))){
+        case ETransportConnectState::Connected:
+            _OnConnected();
+            break;
+        case ETransportConnectState::Failed:
+            _ConnectionLost(ECLIErrorCode::NoServerConnection);
+            break;
+        default:
+            break; /* Deadline checked by _CheckTimeouts */
+    }
+}
+
+void FRemoteClientConnection::_OnConnected(){
+
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Connected to Server"));
+    stats.RecordPhase(ERemoteClientPhase::Connect, startupCycles, FPlatformTime::Cycles64());
+
+    FRemoteClientProtocol::AppendLogin(outBuffer);
+    const bool bPipelined=settings.bPipelineHandshake;
+    if(bPipelined){
+        /* The whole start up in one send (the log-in is not answered). The binary offer goes last so every reply before its ACK is text */
+        FRemoteClientProtocol::AppendSelectMCU(outBuffer, protocol, settings.mcuName);
+        FRemoteClientProtocol::AppendInfoQuery(outBuffer, protocol);
+    }
+    const EWireProtocol offer=_ProtocolOffer();
+    if(offer!=EWireProtocol::Text){
+        /* Offered right behind the log-in, servers without support NACK it: plain text protocol, one order at a time */
+        FRemoteClientProtocol::AppendProtocolQuery(outBuffer, offer);
+    }
+
+    if(!_FlushSend()){
+        /* Log in failed */
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Send Server log-in failed"));
+        _ConnectionLost(ECLIErrorCode::ServerConnError);
+        return;
+    }
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Logged in"));
+
+    err=false;
+    errCode=ECLIErrorCode::CLEAR;
+
+    if(bPipelined){
+        selectedMCU=settings.mcuName;
+        infoQueued=true;
+        protocolQueued=offer!=EWireProtocol::Text;
+        queryCycles=FPlatformTime::Cycles64();
+        _ArmReplyTimeout();
+        status=ECLIStatusCode::ON_MCU_SELECT;
+        return;
+    }
+    if(offer!=EWireProtocol::Text){
+        _ArmReplyTimeout();
+        status=ECLIStatusCode::NEGOTIATING_PROTOCOL;
+        return;
+    }
+    status=ECLIStatusCode::STARTING_UP;
+    _StartSelectMCU(settings.mcuName);
+}
+
+void FRemoteClientConnection::_HandleProtocolReply(const FServerReply& reply){
+
+    const bool bPipelined=protocolQueued;
+    protocolQueued=false;
+
+    if(reply.type==EServerReply::ACK && reply.code==(uint8)EWireProtocol::Binary){
+        /* Every frame after this ACK is binary, in both directions */
+        protocol=EWireProtocol::Binary;
+        decoder.SetBinaryFraming(true);
+        sequencedOrders=true;
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Using binary wire protocol"));
+    }else if(reply.type==EServerReply::ACK && reply.code==(uint8)EWireProtocol::SequencedText){
+        sequencedOrders=true;
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Server tags its ACKs with the order sequence, up to %d orders in flight"), _OrderWindow());
+    }else if(reply.type==EServerReply::NACK){
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Wire protocol %d refused (%d), using text protocol"), (uint8)_ProtocolOffer(), reply.code);
+        if(settings.MaxInFlightOrders>1){
+            UE_LOG(LogRemoteClientSystem, Warning, TEXT("Server does not tag its ACKs with the order sequence: one movement order in flight at a time"));
+        }
+    }else{
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        status=ECLIStatusCode::IDLE;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Corrupt Server Response"));
+        return;
+    }
+
+    if(bPipelined){
+        /* Answered after the start up queries */
+        if(!err.load()){
+            _StartupDone();
+        }
+        return;
+    }
+    status=ECLIStatusCode::STARTING_UP;
+    _StartSelectMCU(settings.mcuName);
+}
+
+void FRemoteClientConnection::_CloseConnection(){
+    err=true;
+    errCode=ECLIErrorCode::NoServerConnection;
+    inFlightOrders.Empty();
+    outBuffer.Reset();
+    infoQueued=false;       /* Nothing is owed on a closed link */
+    protocolQueued=false;
+    discardReplies=0;
+    _FailPriority(ECLIErrorCode::NoServerConnection);
+    streamOn=false;
+    _CloseStreamSocket();
+    if(transport){
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Closing server connection."));
+        transport.Reset();
+    }
+}
+
+/** Drops the connection after a failure, reconnects later if enabled */
+void FRemoteClientConnection::_ConnectionLost(ECLIErrorCode code){
+    _CloseConnection();
+    errCode=code;
+    status=ECLIStatusCode::NO_SERVER_CONN;
+    _FailMovements(code);
+    if(settings.bAutoReconnect && !stopping.load()){
+        _ScheduleReconnect();
+    }
+}
+
+/** Exponential backoff from RECONNECT_MIN_DELAY_S to ReconnectMaxDelayS, each wait drawn in [delay/2, delay] so clients do not retry in lockstep */
+void FRemoteClientConnection::_ScheduleReconnect(){
+    reconnectDelay=FMath::Clamp(reconnectDelay*2.f, RECONNECT_MIN_DELAY_S, FMath::Max(settings.ReconnectMaxDelayS, RECONNECT_MIN_DELAY_S));
+    const float wait=reconnectDelay*(0.5f+0.5f*reconnectJitter.FRand());
+    reconnectAt=FPlatformTime::Seconds()+wait;
+    UE_LOG(LogRemoteClientSystem, Warning, TEXT("Reconnecting in %.2f s"), wait);
+}
+
+void FRemoteClientConnection::_ArmReplyTimeout(){
+    replyDeadline=FPlatformTime::Seconds()+settings.ServerTimeoutS;
+}
+
+/** A silent server is handled as a lost connection, a silent MCU only fails the orders waiting for it when replies are tagged */
+void FRemoteClientConnection::_CheckTimeouts(){
+
+    if(!transport){
+        return;
+    }
+    const double now=FPlatformTime::Seconds();
+
+    if(priorityInFlight.Num()>0 && FPlatformTime::GetSecondsPerCycle64()*(FPlatformTime::Cycles64()-priorityInFlight[0].sentCycles)>settings.PriorityTimeoutS){
+        /* Bounded on its own: whatever the orders are waiting for, a stop that is not confirmed does not leave the link up */
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Priority movement not applied in %.2f s"), settings.PriorityTimeoutS);
+        _FailPriority(ECLIErrorCode::PriorityTimeout);
+        _ConnectionLost(ECLIErrorCode::PriorityTimeout);
+        return;
+    }
+
+    switch(status.load()){
+        case ECLIStatusCode::CONNECTING:
+            if(now>connectDeadline){
+                UE_LOG(LogRemoteClientSystem, Error, TEXT("Server connection timed out"));
+                _ConnectionLost(ECLIErrorCode::ConnectTimeout);
+            }
+            break;
+
+        case ECLIStatusCode::NEGOTIATING_PROTOCOL:
+        case ECLIStatusCode::ON_MCU_SELECT:
+        case ECLIStatusCode::RETRIEVING_INFO_sMCU:
+        case ECLIStatusCode::RETRIEVING_INFO:
+        case ECLIStatusCode::SWITCHING_RT_MODE:
+        case ECLIStatusCode::SWITCHING_TELEMETRY:
+        case ECLIStatusCode::RETRIEVING_LIMITS:
+            if(now>replyDeadline){
+                UE_LOG(LogRemoteClientSystem, Error, TEXT("No server reply in %.1f s"), settings.ServerTimeoutS);
+                _ConnectionLost(ECLIErrorCode::ServerTimeout);
+            }
+            break;
+
+        case ECLIStatusCode::WAITING_SERVER_ACK:
+        case ECLIStatusCode::WAITING_MCU_ACK:
+        {
+            /* Orders are answered in send order, the oldest one is the late one */
+            const FInFlightOrder& oldest=inFlightOrders[0];
+            const double spc=FPlatformTime::GetSecondsPerCycle64();
+            const uint64 nowCycles=FPlatformTime::Cycles64();
+            if(!oldest.serverAcked && (nowCycles-oldest.sentCycles)*spc>settings.ServerTimeoutS){
+                UE_LOG(LogRemoteClientSystem, Error, TEXT("No server ACK for movement order %d in %.1f s"), oldest.seq, settings.ServerTimeoutS);
+                _ConnectionLost(ECLIErrorCode::ServerTimeout);
+            }else if(oldest.serverAcked && (nowCycles-oldest.serverAckCycles)*spc>settings.McuTimeoutS){
+                UE_LOG(LogRemoteClientSystem, Error, TEXT("Movement order %d not completed by MCU in %.1f s"), oldest.seq, settings.McuTimeoutS);
+                if(!sequencedOrders){
+                    /* Untagged replies: the late MCU answer would be taken for the next order's, only a new link resyncs them */
+                    _ConnectionLost(ECLIErrorCode::MCUTimeout);
+                    break;
+                }
+                /* Tagged replies: the late answer no longer matches any order in flight & is dropped */
+                err=true;
+                errCode=ECLIErrorCode::MCUTimeout;
+                inFlightOrders.Empty();
+                _FailMovements(ECLIErrorCode::MCUTimeout);
+                status=ECLIStatusCode::IDLE;
+            }
+            break;
+        }
+
+        default:
+            if((protocolQueued || discardReplies>0) && now>replyDeadline){
+                /* Pipelined answers owed after a failed start up query */
+                UE_LOG(LogRemoteClientSystem, Error, TEXT("No server reply in %.1f s"), settings.ServerTimeoutS);
+                _ConnectionLost(ECLIErrorCode::ServerTimeout);
+            }
+            break;
+    }
+}
+
+void FRemoteClientConnection::_StartSelectMCU(const FString& MCU_Name){
+
+    FRemoteClientProtocol::AppendSelectMCU(outBuffer, protocol, MCU_Name);
+    if(settings.bPipelineHandshake){
+        /* Right behind, answered once the sMCU ACK is in */
+        FRemoteClientProtocol::AppendInfoQuery(outBuffer, protocol);
+    }
+    if(!_FlushSend()){
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Send sMCU query failed"));
+        return;
+    }
+    queryCycles=FPlatformTime::Cycles64();
+    _ArmReplyTimeout();
+    selectedMCU=MCU_Name;
+    infoQueued=settings.bPipelineHandshake;
+    status=ECLIStatusCode::ON_MCU_SELECT;
+}
+
+void FRemoteClientConnection::_StartRetrieveMCUInfo(){
+
+    FRemoteClientProtocol::AppendInfoQuery(outBuffer, protocol);
+    if(!_FlushSend()){
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Send iMCU query failed"));
+        return;
+    }
+    queryCycles=FPlatformTime::Cycles64();
+    _ArmReplyTimeout();
+    status=ECLIStatusCode::RETRIEVING_INFO;
+}
+
+/**
+ *  Puts pending movements on the wire while the window allows it.
+ *  With a window of 1 this is the stop-and-wait SRVP flow. With a bigger window sequenced orders (!s-SRVQ-c-q-...e!)
+ *  are pipelined, the server echoes q in the code byte of both ACKs: first the server ACK, then the MCU ACK. The window is
+ *  only opened once the server ACKed the SequencedText (or binary) offer, see _OrderWindow.
+ *  Binary orders always carry their sequence & the ACK stage, so they are matched the same way in both modes.
+ */
+void FRemoteClientConnection::_SendPendingMovements(){
+
+    if(err.load() || !transport || !servos.HasPending() || protocolQueued){
+        return;
+    }
+    const ECLIStatusCode s=status.load();
+    if(s!=ECLIStatusCode::IDLE&&s!=ECLIStatusCode::WAITING_SERVER_ACK&&s!=ECLIStatusCode::WAITING_MCU_ACK){
+        return;
+    }
+
+    /* Nagle style: the first write of a burst is held for the coalescing window, the writes that follow join it */
+    const double window=_CoalesceWindowS();
+    const uint64 since=servos.GetPendingSinceCycles();
+    if(window>0 && since!=0){
+        const double age=FPlatformTime::GetSecondsPerCycle64()*(FPlatformTime::Cycles64()-since);
+        if(age<window){
+            coalesceDeadline=FPlatformTime::Seconds()+(window-age);
+            return;
+        }
+    }
+    coalesceDeadline=0;
+
+    const int32 orderWindow=_OrderWindow();
+    const bool bPipelined=orderWindow>1;
+    while(inFlightOrders.Num()<orderWindow && servos.HasPending()){
+        FInFlightOrder order;
+        order.serverAcked=false;
+        order.mcuAcked=false;
+        order.ticket=movementTicket.load(std::memory_order_acquire);
+        order.mask=_ApplyDeadband(servos.TakePending(order.positions, order.queuedCycles), order.positions);
+        order.serverAckCycles=0;
+        order.cancelled=false;
+        if(order.mask==0){
+            break;
+        }
+        order.seq=nextOrderSeq++;
+        for(uint32 bits=order.mask; bits; bits&=bits-1){
+            const uint32 i=FMath::CountTrailingZeros(bits);
+            commanded[i]=order.positions[i];
+        }
+
+        /* Send query to server */
+        const int32 frameStart=outBuffer.Num();
+        FRemoteClientProtocol::AppendMovement(outBuffer, protocol, order.seq, bPipelined, order.mask, order.positions);
+        if(recorder){
+            recorder->Record(ERemoteClientLogDirection::Sent, protocol, MakeArrayView(outBuffer.GetData()+frameStart, outBuffer.Num()-frameStart));
+        }
+        if(!_FlushSend()){
+            err=true;
+            errCode=ECLIErrorCode::ServerConnError;
+            UE_LOG(LogRemoteClientSystem, Error, TEXT("Send SRVP query failed"));
+            inFlightOrders.Empty();
+            _FailMovements(ECLIErrorCode::ServerConnError);
+            status=ECLIStatusCode::IDLE;
+            return;
+        }
+        order.sentCycles=FPlatformTime::Cycles64();
+        stats.RecordOrderSent(order.seq, order.queuedCycles, order.sentCycles);
+        inFlightOrders.Add(order);
+    }
+
+    _UpdateOrderStatus();
+}
+
+/**
+ *  Priority lane: sent as soon as the connection is up, whatever the order window is doing. Only the start up & the
+ *  real time mode switch hold it back (a few ms): before their answer the server may not take movements yet.
+ *  In real time mode the targets are streamed right away instead of on the next tick.
+ */
+void FRemoteClientConnection::_SendPriorityMovements(){
+
+    while(FPriorityMovement* next=priorityMovements.Peek()){
+
+        const ECLIStatusCode s=status.load();
+        if(!transport || s==ECLIStatusCode::NO_SERVER_CONN){
+            /* Not kept for a later connection, the robot may be anywhere by then */
+            next->promise.SetValue(ECLIErrorCode::NoServerConnection);
+            priorityMovements.Pop();
+            continue;
+        }
+        /* UACK is its own reply type, so it may cross any query answer. Held only until the MCU is selected & retrieved
+           (start up, each step bounded by its reply timeout) and while the real time mode is being switched */
+        if(s==ECLIStatusCode::CONNECTING || s==ECLIStatusCode::NEGOTIATING_PROTOCOL || s==ECLIStatusCode::ON_MCU_SELECT
+            || s==ECLIStatusCode::RETRIEVING_INFO_sMCU || s==ECLIStatusCode::RETRIEVING_INFO || s==ECLIStatusCode::STARTING_UP
+            || s==ECLIStatusCode::SWITCHING_RT_MODE || protocolQueued){
+            return;
+        }
+
+        FPriorityMovement movement=MoveTemp(*next);
+        priorityMovements.Pop();
+
+        if(movement.bHold && servos.GetServoCount()==0){
+            movement.promise.SetValue(ECLIErrorCode::StaleMCUInfo);
+            continue;
+        }
+
+        if(movement.bCancelPending){
+            _CancelPending();
+        }
+        if(movement.bHold){
+            FServoPositionSnapshot current;
+            servos.ReadSnapshot(current);
+            FMemory::Memcpy(movement.positions, current.positions, current.servoCount);
+            movement.mask=current.servoCount>=MAX_SERVOS ? MAX_uint32 : (1u<<current.servoCount)-1;
+        }
+        for(uint32 bits=movement.mask; bits; bits&=bits-1){
+            const uint32 i=FMath::CountTrailingZeros(bits);
+            commanded[i]=movement.positions[i];
+        }
+
+        if(s==ECLIStatusCode::STREAMING){
+            /* Setpoints never wait for the MCU, the priority targets only skip the tick */
+            for(uint32 bits=movement.mask; bits; bits&=bits-1){
+                const uint32 i=FMath::CountTrailingZeros(bits);
+                streamSetpoints[i]=movement.positions[i];
+            }
+            streamMask|=movement.mask;
+            if(!_SendSetpoints(streamUDP ? streamMask : movement.mask)){
+                movement.promise.SetValue(ECLIErrorCode::ServerConnError);
+                continue;
+            }
+            servos.CommitPositions(streamSetpoints, movement.mask);
+            stats.RecordPhase(ERemoteClientPhase::Priority, movement.queuedCycles, FPlatformTime::Cycles64());
+            movement.promise.SetValue(ECLIErrorCode::CLEAR);
+            continue;
+        }
+
+        const int32 frameStart=outBuffer.Num();
+        FRemoteClientProtocol::AppendPriorityMovement(outBuffer, protocol,
+            movement.bCancelPending ? FRemoteClientProtocol::PRIORITY_CANCEL_QUEUED : 0, movement.mask, movement.positions);
+        if(recorder){
+            recorder->Record(ERemoteClientLogDirection::Sent, protocol, MakeArrayView(outBuffer.GetData()+frameStart, outBuffer.Num()-frameStart));
+        }
+        if(!_FlushSend()){
+            UE_LOG(LogRemoteClientSystem, Error, TEXT("Send SRVU query failed"));
+            movement.promise.SetValue(ECLIErrorCode::ServerConnError);
+            _ConnectionLost(ECLIErrorCode::ServerConnError);
+            return;
+        }
+        movement.sentCycles=FPlatformTime::Cycles64();
+        priorityInFlight.Add(MoveTemp(movement));
+    }
+}
+
+/** Drops everything the normal lane still owes: pending targets, trajectory & in-flight orders (the server drops those too) */
+void FRemoteClientConnection::_CancelPending(){
+
+    trajectory.Clear();
+    trajectoryPlaying=false;
+    for(auto& order : inFlightOrders){
+        order.cancelled=true;   /* Still answered until the server reads the priority movement */
+    }
+    _FailMovements(ECLIErrorCode::Preempted);   /* Drops the pending targets */
+}
+
+void FRemoteClientConnection::_HandlePriorityReply(const FServerReply& reply){
+
+    if(priorityInFlight.Num()==0){
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Unexpected priority answer ignored"));
+        return;
+    }
+    FPriorityMovement movement=MoveTemp(priorityInFlight[0]);
+    priorityInFlight.RemoveAt(0, 1, false);
+
+    if(movement.bCancelPending){
+        /* Orders the server dropped are never answered, the ones it refused to drop complete as usual */
+        if(reply.code==0){
+            inFlightOrders.RemoveAll([](const FInFlightOrder& o){ return o.cancelled; });
+        }else{
+            for(auto& order : inFlightOrders){
+                order.cancelled=false;
+            }
+        }
+        const ECLIStatusCode s=status.load();
+        if(s==ECLIStatusCode::WAITING_SERVER_ACK || s==ECLIStatusCode::WAITING_MCU_ACK){
+            _UpdateOrderStatus();
+        }
+    }
+
+    if(reply.code!=0){
+        stats.RecordNack(reply.code);
+        err=true;
+        errCode=ECLIErrorCode(reply.code);
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Priority movement refused with error code: %d"), reply.code);
+        movement.promise.SetValue(ECLIErrorCode(reply.code));
+        return;
+    }
+    stats.RecordPhase(ERemoteClientPhase::Priority, movement.queuedCycles, FPlatformTime::Cycles64());
+    servos.CommitPositions(movement.positions, movement.mask);
+    movement.promise.SetValue(ECLIErrorCode::CLEAR);
+}
+
+void FRemoteClientConnection::_FailPriority(ECLIErrorCode code){
+    for(auto& movement : priorityInFlight){
+        movement.promise.SetValue(code);
+    }
+    priorityInFlight.Empty();
+}
+
+/** Fixed window, or in adaptive mode a quarter of the round trip each in-flight order slot gets (capped by the fixed window) */
+double FRemoteClientConnection::_CoalesceWindowS() const{
+    const double maxWindow=settings.CoalesceWindowUs/1e6;
+    if(!settings.bAdaptiveCoalescing || maxWindow<=0){
+        return maxWindow;
+    }
+    /* Orders can't complete faster than this anyway, holding a fraction of it costs little & spares round trips */
+    return FMath::Min(maxWindow, orderRttS/(4.0*_OrderWindow()));
+}
+
+/** Binary carries the order sequence. Text only does with SRVQ, which the server has to confirm first */
+EWireProtocol FRemoteClientConnection::_ProtocolOffer() const{
+    if(settings.bUseBinaryProtocol){
+        return EWireProtocol::Binary;
+    }
+    return settings.MaxInFlightOrders>1 ? EWireProtocol::SequencedText : EWireProtocol::Text;
+}
+
+/** Orders that may be in flight: a server that does not tag its ACKs can only be matched one order at a time, text tags wrap at 32 */
+int32 FRemoteClientConnection::_OrderWindow() const{
+    if(!sequencedOrders){
+        return 1;
+    }
+    return FMath::Clamp(settings.MaxInFlightOrders, 1, protocol==EWireProtocol::Binary ? MAX_int32 : FRemoteClientProtocol::MAX_TEXT_ORDER_WINDOW);
+}
+
+/** Drops the targets within the deadband of the last commanded position. Returns the servos left */
+uint32 FRemoteClientConnection::_ApplyDeadband(uint32 mask, const uint8 (&targets)[MAX_SERVOS]){
+    if(settings.Deadband<0){
+        return mask;
+    }
+    uint32 kept=mask;
+    for(uint32 bits=mask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        if(FMath::Abs((int32)targets[i]-(int32)commanded[i])<=settings.Deadband){
+            kept&=~(1u<<i);
+        }
+    }
+    if(kept!=mask){
+        stats.RecordDeadbandDrops(FMath::CountBits(mask&~kept));
+    }
+    return kept;
+}
+
+/** Orders were dropped, what the MCU was told is only known from the current positions */
+void FRemoteClientConnection::_ResyncCommanded(){
+    FServoPositionSnapshot current;
+    servos.ReadSnapshot(current);
+    FMemory::Memcpy(commanded, current.positions, current.servoCount);
+}
+
+/** Asks the server for real time mode, streaming starts once it is ACKed */
+void FRemoteClientConnection::_StartStreaming(float RateHz, bool bUseUDP){
+
+    streamPeriod=1.0/FMath::Clamp(RateHz, 1.f, 1000.f);
+    streamUDP=bUseUDP;
+    if(streamUDP && settings.Transport==ERemoteClientTransport::SharedMemory){
+        /* The shared memory rings are already cheaper than datagrams, and the server may not listen on UDP at all */
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Streaming over the shared memory transport instead of UDP"));
+        streamUDP=false;
+    }
+
+    if(streamUDP){
+        ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+        udpAddr = SocketSubsystem->CreateInternetAddr();
+        bool bIsValid;
+        udpAddr->SetIp(*settings.IpAdr, bIsValid);
+        udpAddr->SetPort(settings.StreamUdpPort);
+        udpSck = bIsValid ? SocketSubsystem->CreateSocket(NAME_DGram, TEXT("Stream socket"), false) : nullptr;
+        if(!udpSck){
+            err=true;
+            errCode=ECLIErrorCode::ServerConnError;
+            UE_LOG(LogRemoteClientSystem, Error, TEXT("Could not open UDP stream socket"));
+            return;
+        }
+        udpSck->SetNonBlocking(true);
+    }
+
+    streamOn=true;
+    FRemoteClientProtocol::AppendRealTimeMode(outBuffer, protocol, true);
+    if(!_FlushSend()){
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Send RTMD query failed"));
+        streamOn=false;
+        _CloseStreamSocket();
+        return;
+    }
+    _ArmReplyTimeout();
+    status=ECLIStatusCode::SWITCHING_RT_MODE;
+}
+
+void FRemoteClientConnection::_HandleRealTimeModeReply(const FServerReply& reply){
+
+    if(reply.type==EServerReply::ACK){
+        if(streamOn){
+            /* Setpoints queued before streaming started go out on the first tick */
+            streamSeq=0;
+            streamMask=0;
+            nextStreamTick=FPlatformTime::Seconds();
+            status=ECLIStatusCode::STREAMING;
+            UE_LOG(LogRemoteClientSystem, Display, TEXT("Streaming at %.0f Hz over %s"), 1.0/streamPeriod, streamUDP ? TEXT("UDP") : TEXT("TCP"));
+        }else{
+            _CloseStreamSocket();
+            status=ECLIStatusCode::IDLE;
+            UE_LOG(LogRemoteClientSystem, Display, TEXT("Streaming stopped"));
+        }
+        return;
+    }
+
+    err=true;
+    errCode=reply.type==EServerReply::NACK ? ECLIErrorCode(reply.code) : ECLIErrorCode::ServerConnError;
+    UE_LOG(LogRemoteClientSystem, Error, TEXT("RTMD Failed %d"), reply.code);
+    streamOn=false;
+    _CloseStreamSocket();
+    status=ECLIStatusCode::IDLE;
+}
+
+/**
+ *  Sends one setpoint frame per period with the latest target of each servo, nothing waits for the MCU.
+ *  Over TCP only the servos that changed are sent. Datagrams may be lost, so over UDP every frame carries the full setpoint
+ *  and the receiver drops frames older than the last sequence it applied.
+ */
+void FRemoteClientConnection::_StreamTick(){
+
+    if(status.load()!=ECLIStatusCode::STREAMING || err.load()){
+        return;
+    }
+    const double now=FPlatformTime::Seconds();
+    if(now<nextStreamTick){
+        return;
+    }
+    /* Keep the cadence, unless we fell more than a period behind */
+    nextStreamTick = now-nextStreamTick>streamPeriod ? now+streamPeriod : nextStreamTick+streamPeriod;
+
+    uint8 latest[MAX_SERVOS];
+    uint64 sinceCycles;
+    const uint64 ticket=movementTicket.load(std::memory_order_acquire);
+    const uint32 changed=_ApplyDeadband(servos.TakePending(latest, sinceCycles), latest);
+    for(uint32 bits=changed; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        streamSetpoints[i]=latest[i];
+        commanded[i]=latest[i];
+    }
+    streamMask|=changed;
+
+    const uint32 mask=streamUDP ? streamMask : changed;
+    if(mask==0){
+        completedTicket=FMath::Max(completedTicket, ticket);
+        return;
+    }
+
+    if(!_SendSetpoints(mask)){
+        return;
+    }
+
+    /* No completion in real time mode, current positions follow the commanded setpoints */
+    servos.CommitPositions(streamSetpoints, changed);
+    completedTicket=FMath::Max(completedTicket, ticket);
+}
+
+/** One setpoint frame of the servos in mask. Returns false if the TCP send failed */
+bool FRemoteClientConnection::_SendSetpoints(uint32 mask){
+
+    if(streamUDP){
+        datagram.Reset();
+        FRemoteClientProtocol::AppendSetpoint(datagram, protocol, streamSeq++, mask, streamSetpoints);
+        int32 bySent=0;
+        if(!udpSck->SendTo(datagram.GetData(), datagram.Num(), bySent, *udpAddr)){
+            UE_LOG(LogRemoteClientSystem, Verbose, TEXT("Setpoint datagram dropped"));
+        }
+        return true;
+    }
+    FRemoteClientProtocol::AppendSetpoint(outBuffer, protocol, streamSeq++, mask, streamSetpoints);
+    if(!_FlushSend()){
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Send RTSP frame failed"));
+        _FailMovements(ECLIErrorCode::ServerConnError);
+        return false;
+    }
+    return true;
+}
+
+/** Resamples the playing trajectory at the control rate into the pending table, the usual movement flow sends it */
+void FRemoteClientConnection::_TrajectoryTick(){
+
+    if(!trajectory.IsActive()){
+        return;
+    }
+    if(err.load()){
+        /* Resuming after ClearErr would jump to wherever the trajectory is by then */
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Trajectory stopped on error"));
+        trajectory.Clear();
+        trajectoryPlaying=false;
+        return;
+    }
+
+    const double now=FPlatformTime::Seconds();
+    if(now<nextTrajectoryTick){
+        return;
+    }
+    /* Keep the cadence, unless we fell more than a period behind */
+    nextTrajectoryTick = now-nextTrajectoryTick>trajectoryPeriod ? now+trajectoryPeriod : nextTrajectoryTick+trajectoryPeriod;
+
+    uint8 positions[MAX_SERVOS];
+    const uint32 mask=trajectory.Sample(now, positions);
+    if(mask!=0){
+        if(settings.LimitMode!=ERemoteClientLimitMode::Off){
+            /* Keyframes were checked against the full range only, the path in between is held inside the limits */
+            servos.ClampToLimits(positions, positions);
+        }
+        const uint32 coalesced=servos.SetPending(positions, mask);
+        stats.RecordWrites(FMath::CountBits(mask), FMath::CountBits(coalesced));
+    }
+    trajectoryPlaying=trajectory.IsActive();
+}
+
+/** Time until the stream or the trajectory needs the connection thread again */
+double FRemoteClientConnection::_SecondsToNextTick() const{
+    const double now=FPlatformTime::Seconds();
+    double next=IDLE_WAIT_MS/1000.0;
+    if(coalesceDeadline>0){
+        next=FMath::Min(next, coalesceDeadline-now);
+    }
+    if(status.load()==ECLIStatusCode::STREAMING){
+        next=FMath::Min(next, nextStreamTick-now);
+    }
+    if(trajectory.IsActive()){
+        next=FMath::Min(next, nextTrajectoryTick-now);
+    }
+    return FMath::Max(0.0, next);
+}
+
+void FRemoteClientConnection::_CloseStreamSocket(){
+    if(udpSck){
+        udpSck->Close();
+        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(udpSck);
+        udpSck = nullptr;
+    }
+    udpAddr.Reset();
+}
+
+void FRemoteClientConnection::_UpdateOrderStatus(){
+    stats.RecordInFlight(inFlightOrders.Num());
+    if(inFlightOrders.Num()==0){
+        status=ECLIStatusCode::IDLE; /* Return to idle status */
+    }else{
+        status=inFlightOrders[0].serverAcked ? ECLIStatusCode::WAITING_MCU_ACK : ECLIStatusCode::WAITING_SERVER_ACK;
+    }
+}
+
+void FRemoteClientConnection::_Poll(){
+
+    if(!transport){
+        /* Sleep until a command arrives or the next reconnection attempt */
+        double wait=IDLE_WAIT_MS/1000.0;
+        if(reconnectAt>0){
+            wait=FMath::Clamp(reconnectAt-FPlatformTime::Seconds(), 0.0, wait);
+        }
+        wakeEvent->Wait(FTimespan::FromSeconds(wait));
+        return;
+    }
+    if(status.load()==ECLIStatusCode::CONNECTING){
+        _PollConnect();
+        return;
+    }
+    const double untilTick=_SecondsToNextTick();
+
+    if(outBuffer.Num()>0 && !_FlushSend()){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Server connection failed"));
+        _ConnectionLost(ECLIErrorCode::ServerConnError);
+        return;
+    }
+
+    if(status.load()==ECLIStatusCode::STREAMING){
+        /* Sleep on the socket until the next setpoint is due */
+        if(!transport->WaitForRead(FTimespan::FromSeconds(untilTick))){
+            return;
+        }
+    }else if(_IsBusy() || priorityInFlight.Num()>0){
+        /* Replies expected, wake up as soon as they arrive */
+        if(!transport->WaitForRead(FTimespan::FromMicroseconds(FMath::Min<double>(REPLY_POLL_US, untilTick*1e6)))){
+            return;
+        }
+    }else{
+        /* Nothing expected, sleep until a command arrives (or the next trajectory sample) and then check the socket without blocking */
+        wakeEvent->Wait(FTimespan::FromSeconds(untilTick));
+    }
+
+    _ReadSocket();
+}
+
+void FRemoteClientConnection::_ReadSocket(){
+
+    while(transport){
+        int32 freeBytes=0;
+        uint8* dst=decoder.GetWriteBuffer(freeBytes);
+        int32 byRead=0;
+        if(!transport->Recv(dst, freeBytes, byRead)){
+            UE_LOG(LogRemoteClientSystem, Error, TEXT("Server connection failed"));
+            _ConnectionLost(ECLIErrorCode::NoServerConnection);
+            return;
+        }
+        if(byRead<=0){
+            return; /* Nothing else to read */
+        }
+        decoder.CommitWrite(byRead);
+
+        /* Several replies may have arrived on the same read */
+        TArrayView<const uint8> frame;
+        EFrameDecodeResult res;
+        while((res=decoder.Next(frame))!=EFrameDecodeResult::Incomplete){
+            if(res==EFrameDecodeResult::Corrupt){
+                _HandleCorruptFrame();
+                continue;
+            }
+            _HandleFrame(frame);
+        }
+    }
+}
+
+/** Undecodable or unparseable frame: the reply it carried is lost, so whatever waited for it fails now rather than on its timeout */
+void FRemoteClientConnection::_HandleCorruptFrame(){
+    const ECLIStatusCode s=status.load();
+    const bool bReplyExpected=_IsReplyExpected();
+    UE_LOG(LogRemoteClientSystem, Error, TEXT("Corrupt Server Response"));
+    if(protocolQueued || infoQueued || discardReplies>0 || s==ECLIStatusCode::NEGOTIATING_PROTOCOL || s==ECLIStatusCode::ON_MCU_SELECT
+        || s==ECLIStatusCode::RETRIEVING_INFO_sMCU || s==ECLIStatusCode::RETRIEVING_INFO){
+        /* Pipelined start up: which answer was lost is unknown, the next one would land on the wrong stage */
+        _ConnectionLost(ECLIErrorCode::ServerConnError);
+        return;
+    }
+    err=true;
+    errCode=ECLIErrorCode::ServerConnError;
+    if(inFlightOrders.Num()>0){
+        _FailMovements(ECLIErrorCode::ServerConnError);
+    }
+    if(bReplyExpected){
+        inFlightOrders.Empty();
+        status=ECLIStatusCode::IDLE;
+    }
+}
+
+void FRemoteClientConnection::_HandleFrame(TArrayView<const uint8> frame){
+
+    FServerReply reply;
+    if(!FRemoteClientProtocol::ParseReply(protocol, frame, reply)){
+        _HandleCorruptFrame();
+        return;
+    }
+    if(reply.type==EServerReply::NACK){
+        stats.RecordNack(reply.code);
+    }
+    if(recorder && reply.type!=EServerReply::Telemetry){
+        recorder->Record(ERemoteClientLogDirection::Received, protocol, frame);
+    }
+    if(reply.type==EServerReply::Telemetry){
+        /* Pushed in between any replies, never answers a query */
+        _HandleTelemetry(reply);
+        return;
+    }
+    if(reply.type==EServerReply::Priority){
+        /* Own lane, answered ahead of the orders queued before it */
+        _HandlePriorityReply(reply);
+        return;
+    }
+    if(discardReplies>0){
+        discardReplies--;
+        UE_LOG(LogRemoteClientSystem, Verbose, TEXT("Answer to a query pipelined behind a failed one dropped"));
+        return;
+    }
+    if(protocolQueued && status.load()!=ECLIStatusCode::ON_MCU_SELECT && status.load()!=ECLIStatusCode::RETRIEVING_INFO){
+        /* The pipelined binary offer is answered last, it switches the framing even if the start up failed */
+        _HandleProtocolReply(reply);
+        return;
+    }
+
+    switch(status.load()){
+        case ECLIStatusCode::NEGOTIATING_PROTOCOL:
+            _HandleProtocolReply(reply);
+            break;
+
+        case ECLIStatusCode::ON_MCU_SELECT:
+            _HandleSelectReply(reply);
+            break;
+
+        case ECLIStatusCode::RETRIEVING_INFO:
+            _HandleInfoReply(reply);
+            break;
+
+        case ECLIStatusCode::SWITCHING_RT_MODE:
+            _HandleRealTimeModeReply(reply);
+            break;
+
+        case ECLIStatusCode::SWITCHING_TELEMETRY:
+            _HandleTelemetryReply(reply);
+            break;
+
+        case ECLIStatusCode::RETRIEVING_LIMITS:
+            _HandleLimitsReply(reply);
+            break;
+
+        case ECLIStatusCode::STREAMING:
+            if(reply.type==EServerReply::NACK){
+                /* Stays in real time mode until StopStreaming */
+                err=true;
+                errCode=ECLIErrorCode(reply.code);
+                UE_LOG(LogRemoteClientSystem, Error, TEXT("Real time stream refused with error code: %d"), reply.code);
+            }
+            break;
+
+        case ECLIStatusCode::WAITING_SERVER_ACK:
+        case ECLIStatusCode::WAITING_MCU_ACK:
+            if(!_HandleOrderReply(reply)){
+                _FailMovements(errCode.load());
+                inFlightOrders.Empty();
+                status=ECLIStatusCode::IDLE;
+                return;
+            }
+            _UpdateOrderStatus();
+            break;
+
+        default:
+            UE_LOG(LogRemoteClientSystem, Warning, TEXT("Unexpected server frame (%d bytes) ignored"), frame.Num());
+            break;
+    }
+}
+
+void FRemoteClientConnection::_HandleSelectReply(const FServerReply& reply){
+
+    if(reply.type==EServerReply::ACK){
+
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("sMCU successful: Now controlling %s"), *selectedMCU);
+        stats.RecordPhase(ERemoteClientPhase::SelectMCU, queryCycles, FPlatformTime::Cycles64());
+
+        if(infoQueued){
+            /* iMCU already sent, its answer is next */
+            infoQueued=false;
+            queryCycles=FPlatformTime::Cycles64();
+            _ArmReplyTimeout();
+            status=ECLIStatusCode::RETRIEVING_INFO;
+            return;
+        }
+
+    }else if(reply.type==EServerReply::NACK){
+        if(infoQueued){
+            /* The iMCU behind is answered anyway, the sMCU code is the one reported */
+            infoQueued=false;
+            discardReplies++;
+        }
+        err=true;
+        errCode=ECLIErrorCode(reply.code);
+        status=ECLIStatusCode::IDLE;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("sMCU Failed %d"), reply.code);
+        return;
+    }else{
+        if(infoQueued){
+            infoQueued=false;
+            discardReplies++;
+        }
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        status=ECLIStatusCode::IDLE;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Corrupt Server Response"));
+        return;
+    }
+
+    status=ECLIStatusCode::RETRIEVING_INFO_sMCU;
+    _StartRetrieveMCUInfo();
+}
+
+void FRemoteClientConnection::_HandleInfoReply(const FServerReply& reply){
+
+    if(reply.type==EServerReply::iMCU){
+
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("iMCU successful"));
+
+        uint8 tmp[MAX_SERVOS];
+        const uint8 count=reply.servoCount;
+        if(count==0 || count>MAX_SERVOS){
+            err=true;
+            errCode=ECLIErrorCode::CorruptedICMU;
+            status=ECLIStatusCode::IDLE;
+            return;
+        }
+
+        for(auto i=0; i<count; i++){
+            if(2*i>=reply.servoDataLen){
+                err=true;
+                errCode=ECLIErrorCode::CorruptedICMU;
+                status=ECLIStatusCode::IDLE;
+                return;
+            }
+            tmp[i]=reply.servoData[2*i];
+        }
+
+        if(warmStarted){
+            _ReconcileWarmStart(tmp, count);
+        }else{
+            /* Save current positions, pending targets refer to the previous MCU */
+            servos.Reset(tmp, count);
+        }
+        FMemory::Memcpy(commanded, tmp, count);
+        if(settings.bWarmStart){
+            FRemoteMCUInfoCache::Save(selectedMCU, tmp, count);
+        }
+
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Retrieved %d servo positions"), count);
+        reconnectDelay=0; /* Fully back up, the next failure starts a new backoff */
+
+        const uint64 now=FPlatformTime::Cycles64();
+        stats.RecordPhase(ERemoteClientPhase::MCUInfo, queryCycles, now);
+        stats.RecordPhase(ERemoteClientPhase::Startup, startupCycles, now);
+        startupCycles=0;
+
+    }else if(reply.type==EServerReply::NACK){
+        err=true;
+        errCode=ECLIErrorCode(reply.code);
+        status=ECLIStatusCode::IDLE;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("iMCU Failed %d"), reply.code);
+        return;
+    }else{
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        status=ECLIStatusCode::IDLE;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Corrupt Server Response"));
+        return;
+    }
+
+    if(protocolQueued){
+        /* Pipelined binary offer still to be answered */
+        _ArmReplyTimeout();
+        status=ECLIStatusCode::NEGOTIATING_PROTOCOL;
+        return;
+    }
+    _StartupDone();
+}
+
+void FRemoteClientConnection::_StartupDone(){
+    if(settings.LimitMode!=ERemoteClientLimitMode::Off && (!limitsRetrieved || limitsMCU!=selectedMCU)){
+        /* Once per MCU & server session, every movement is then checked against the MCU limits before it is sent */
+        _StartRetrieveLimits();
+        return;
+    }
+    if(telemetryRateHz>0 && !telemetryOn){
+        /* New server session (reconnection), subscribe again before anything else */
+        _StartTelemetry();
+        return;
+    }
+    status=ECLIStatusCode::IDLE; /* Return to idle status */
+}
+
+/** Loads the cached iMCU of the MCU to connect to, movements are then queued while the start up sequence runs */
+void FRemoteClientConnection::_WarmStart(){
+
+    uint8 positions[MAX_SERVOS];
+    uint8 count=0;
+    warmStarted=false;
+    if(!settings.bWarmStart || !FRemoteMCUInfoCache::Load(settings.mcuName, positions, count)){
+        return;
+    }
+    servos.Reset(positions, count);
+    FMemory::Memcpy(commanded, positions, count);
+    if(settings.LimitMode!=ERemoteClientLimitMode::Off){
+        _LoadCachedLimits(settings.mcuName);
+    }
+    /* Nothing goes on the wire before the start up sequence is over, the status gates the orders */
+    err=false;
+    errCode=ECLIErrorCode::CLEAR;
+    warmStarted=true;
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Warm start of %s from cached MCU info (%d servos)"), *settings.mcuName, count);
+}
+
+/**
+ * First iMCU after a warm start. Same servo count: the real positions replace the cached ones & the queued movements are kept.
+ * Different servo count: the queued movements may address servos that do not exist, they are all rejected.
+ */
+void FRemoteClientConnection::_ReconcileWarmStart(const uint8* positions, uint8 count){
+
+    warmStarted=false;
+    if(count==servos.GetServoCount()){
+        if(servos.UpdatePositions(positions, count)!=0){
+            UE_LOG(LogRemoteClientSystem, Display, TEXT("Cached MCU info was stale, positions refreshed"));
+        }
+        return;
+    }
+    UE_LOG(LogRemoteClientSystem, Warning, TEXT("Cached MCU info had %d servos, the MCU has %d: queued movements rejected"), servos.GetServoCount(), count);
+    servos.Reset(positions, count);
+    _FailMovements(ECLIErrorCode::StaleMCUInfo);
+}
+
+void FRemoteClientConnection::_StartRetrieveLimits(){
+
+    if(limitsMCU!=selectedMCU && !_LoadCachedLimits(selectedMCU)){
+        /* Limits of another MCU, the full range until the lMCU answer */
+        servos.ResetMCULimits();
+        limitsMCU.Empty();
+    }
+    FRemoteClientProtocol::AppendLimitsQuery(outBuffer, protocol);
+    if(!_FlushSend()){
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Send lMCU query failed"));
+        status=ECLIStatusCode::IDLE;
+        return;
+    }
+    _ArmReplyTimeout();
+    status=ECLIStatusCode::RETRIEVING_LIMITS;
+}
+
+/** Limits reply, 3 bytes per servo: min, max (1-180), separator. Servers without limits NACK it, the full range is kept */
+void FRemoteClientConnection::_HandleLimitsReply(const FServerReply& reply){
+
+    if(reply.type==EServerReply::Limits){
+        const uint8 count=reply.servoCount;
+        uint8 minWire[MAX_SERVOS];
+        uint8 maxWire[MAX_SERVOS];
+        FMemory::Memset(minWire, 1);
+        FMemory::Memset(maxWire, 180);
+        bool bValid=count>0 && count<=MAX_SERVOS && 3*count<=reply.servoDataLen+1;
+        for(auto i=0; bValid && i<count; i++){
+            minWire[i]=reply.servoData[3*i];
+            maxWire[i]=reply.servoData[3*i+1];
+            bValid=minWire[i]>=1 && maxWire[i]<=180 && minWire[i]<=maxWire[i];
+        }
+        if(bValid){
+            servos.SetMCULimits(minWire, maxWire);
+            if(settings.bWarmStart){
+                FRemoteMCUInfoCache::SaveLimits(selectedMCU, minWire, maxWire, count);
+            }
+            UE_LOG(LogRemoteClientSystem, Display, TEXT("Retrieved the limits of %d servos"), count);
+        }else{
+            servos.ResetMCULimits();
+            UE_LOG(LogRemoteClientSystem, Warning, TEXT("Corrupt lMCU reply, servo limits unknown: only the full range is checked"));
+        }
+    }else if(reply.type==EServerReply::NACK){
+        /* Servers without lMCU: enforcement falls back to the full range & the user limits, see HasMCULimits */
+        servos.ResetMCULimits();
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Server refused lMCU (%d): MCU limits unsupported for %s, only the full range & SetServoLimits are enforced"),
+            reply.code, *selectedMCU);
+    }else{
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        status=ECLIStatusCode::IDLE;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Corrupt Server Response"));
+        return;
+    }
+
+    /* Not asked again on this session, a NACK included */
+    limitsMCU=selectedMCU;
+    limitsRetrieved=true;
+    _StartupDone();
+}
+
+bool FRemoteClientConnection::_LoadCachedLimits(const FString& MCU_Name){
+    uint8 minWire[MAX_SERVOS];
+    uint8 maxWire[MAX_SERVOS];
+    uint8 count=0;
+    if(!settings.bWarmStart || !FRemoteMCUInfoCache::LoadLimits(MCU_Name, minWire, maxWire, count)){
+        return false;
+    }
+    FMemory::Memset(minWire+count, 1, MAX_SERVOS-count);
+    FMemory::Memset(maxWire+count, 180, MAX_SERVOS-count);
+    servos.SetMCULimits(minWire, maxWire);
+    limitsMCU=MCU_Name;
+    return true;
+}
+
+void FRemoteClientConnection::_StartTelemetry(){
+
+    FRemoteClientProtocol::AppendTelemetryRequest(outBuffer, protocol, telemetryRateHz);
+    if(!_FlushSend()){
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Send TLMS query failed"));
+        status=ECLIStatusCode::IDLE;
+        return;
+    }
+    _ArmReplyTimeout();
+    status=ECLIStatusCode::SWITCHING_TELEMETRY;
+}
+
+void FRemoteClientConnection::_HandleTelemetryReply(const FServerReply& reply){
+
+    if(reply.type==EServerReply::ACK){
+        telemetryOn=telemetryRateHz>0;
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Telemetry at %d Hz"), telemetryRateHz);
+        status=ECLIStatusCode::IDLE;
+        return;
+    }
+
+    err=true;
+    errCode=reply.type==EServerReply::NACK ? ECLIErrorCode(reply.code) : ECLIErrorCode::ServerConnError;
+    UE_LOG(LogRemoteClientSystem, Error, TEXT("TLMS Failed %d"), reply.code);
+    telemetryRateHz=0; /* Not requested again on reconnection */
+    telemetryOn=false;
+    status=ECLIStatusCode::IDLE;
+}
+
+/** Measured positions, 2 bytes per servo like iMCU. Only the servos that moved bump the version & are reported */
+void FRemoteClientConnection::_HandleTelemetry(const FServerReply& reply){
+
+    const uint8 count=FMath::Min<uint8>(reply.servoCount, MAX_SERVOS);
+    if(count==0 || 2*count>reply.servoDataLen+1){
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Corrupt telemetry frame ignored"));
+        return;
+    }
+    uint8 measured[MAX_SERVOS];
+    for(auto i=0; i<count; i++){
+        measured[i]=reply.servoData[2*i];
+    }
+
+    const uint32 moved=servos.UpdatePositions(measured, count);
+    if(moved!=0 && movedServos.fetch_or(moved)==0 && onServosMoved){
+        /* Only when the previous moves were taken, a slow consumer gets one notification for many frames */
+        onServosMoved();
+    }
+}
+
+/** Matches an ACK/NACK to its in-flight order. Returns false if the order window has to be dropped */
+bool FRemoteClientConnection::_HandleOrderReply(const FServerReply& reply){
+
+    if(reply.type==EServerReply::NACK){
+        /* Any denial aborts the whole window, later orders were built on top of the denied one */
+        err=true;
+        errCode=ECLIErrorCode(reply.code);
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("SRVP Denied with error code: %d (%d orders in flight)"), reply.code, inFlightOrders.Num());
+        return false;
+    }
+    if(reply.type!=EServerReply::ACK){
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Corrupt Server Response"));
+        return false;
+    }
+
+    FInFlightOrder* order=nullptr;
+    if(protocol==EWireProtocol::Binary){
+        const uint16 seq=reply.seq;
+        order=inFlightOrders.FindByPredicate([seq](const FInFlightOrder& o){ return o.seq==seq && !o.mcuAcked; });
+        if(order && (reply.stage==FRemoteClientProtocol::STAGE_SERVER)==order->serverAcked){
+            order=nullptr; /* Stage does not match what the order is waiting for */
+        }
+    }else if(sequencedOrders){
+        const uint8 tag=reply.code;   /* !s-_ACK-q-e! */
+        order=inFlightOrders.FindByPredicate([tag](const FInFlightOrder& o){ return FRemoteClientProtocol::TextSeqTag(o.seq)==tag && !o.mcuAcked; });
+    }else if(inFlightOrders.Num()>0){
+        /* SRVP replies are untagged and always refer to the single order in flight */
+        order=&inFlightOrders[0];
+    }
+    if(!order && sequencedOrders){
+        /* Tagged: the answer to an order already failed (MCU timeout), nothing in flight is affected */
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Late ACK for movement order %d dropped"), protocol==EWireProtocol::Binary ? reply.seq : reply.code);
+        return true;
+    }
+    if(!order){
+        err=true;
+        errCode=ECLIErrorCode::ServerConnError;
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("ACK for unknown movement order %d"), protocol==EWireProtocol::Binary ? reply.seq : reply.code);
+        return false;
+    }
+
+    const uint64 now=FPlatformTime::Cycles64();
+    if(!order->serverAcked){
+        order->serverAcked=true;
+        order->serverAckCycles=now;
+        stats.RecordPhase(ERemoteClientPhase::ServerAck, order->sentCycles, now, order->seq);
+        UE_LOG(LogRemoteClientSystem, Verbose, TEXT("Movement order %d Accepted by server"), order->seq);
+        return true;
+    }
+
+    order->mcuAcked=true;
+    stats.RecordOrderCompleted(order->seq, order->queuedCycles, order->serverAckCycles, now);
+
+    /* Smoothed like a TCP SRTT (1/8 gain), drives the adaptive coalescing window */
+    const double rtt=FPlatformTime::GetSecondsPerCycle64()*(now-order->sentCycles);
+    orderRttS = orderRttS>0 ? orderRttS+(rtt-orderRttS)/8.0 : rtt;
+    UE_LOG(LogRemoteClientSystem, Verbose, TEXT("Movement order %d completed by MCU"), order->seq);
+
+    /* Commit completed orders in the order they were sent */
+    int32 completed=0;
+    while(completed<inFlightOrders.Num() && inFlightOrders[completed].mcuAcked){
+        /* Update current servo positions */
+        servos.CommitPositions(inFlightOrders[completed].positions, inFlightOrders[completed].mask);
+        completedTicket=FMath::Max(completedTicket, inFlightOrders[completed].ticket);
+        completed++;
+    }
+    inFlightOrders.RemoveAt(0, completed);
+    return true;
+}
+
+void FRemoteClientConnection::_Reject(FCommand& cmd, ECLIErrorCode code){
+    if(cmd.promise){
+        cmd.promise->SetValue(code);
+        cmd.promise.Reset();
+    }
+}
+
+/** Connect, SelectMCU, RetrieveMCUInfo & SubscribeTelemetry run until their query (or start up sequence) is answered or fails */
+bool FRemoteClientConnection::_IsQueryPending() const{
+    switch(status.load()){
+        case ECLIStatusCode::CONNECTING:
+        case ECLIStatusCode::NEGOTIATING_PROTOCOL:
+        case ECLIStatusCode::ON_MCU_SELECT:
+        case ECLIStatusCode::RETRIEVING_INFO_sMCU:
+        case ECLIStatusCode::RETRIEVING_INFO:
+        case ECLIStatusCode::SWITCHING_TELEMETRY:
+        case ECLIStatusCode::RETRIEVING_LIMITS:
+            return true;
+        case ECLIStatusCode::STARTING_UP:
+            return !err.load();
+        default:
+            return false;
+    }
+}
+
+void FRemoteClientConnection::_SettleQuery(){
+    if(queryPromise && !_IsQueryPending()){
+        queryPromise->SetValue(err.load() ? errCode.load() : ECLIErrorCode::CLEAR);
+        queryPromise.Reset();
+    }
+}
+
+/** Every movement sent so far is lost, whether it was in flight or still pending */
+void FRemoteClientConnection::_FailMovements(ECLIErrorCode code){
+
+    /* Ticket read first: the targets of every failed ticket were pending before it, none is sent after a ClearErr */
+    const uint64 issued=movementTicket.load(std::memory_order_seq_cst);
+    uint8 dropped[MAX_SERVOS];
+    uint64 sinceCycles;
+    servos.TakePending(dropped, sinceCycles);
+    coalesceDeadline=0;
+    _ResyncCommanded();
+
+    /* Every failure keeps its own range, a later one never resolves the waiters of an earlier one */
+    if(issued>completedTicket){
+        failedRanges.Add({completedTicket, issued, code});
+        completedTicket=issued;
+    }
+}
+
+void FRemoteClientConnection::_SettleMovements(){
+
+    /* Nothing pending nor in flight: every movement up to the ticket read first went through (or failed) */
+    const uint64 issued=movementTicket.load(std::memory_order_seq_cst);
+    if(!err.load() && status.load()==ECLIStatusCode::IDLE && inFlightOrders.Num()==0 && !servos.HasPending()){
+        completedTicket=FMath::Max(completedTicket, issued);
+    }
+    /* Read after the ticket & before draining: if no caller is between its ticket & its waiter, every waiter up to it is queued */
+    const bool bLateWaiters=queueingWaiters.load(std::memory_order_seq_cst)>0;
+
+    /* Waiters are queued right after their ticket, the ones that were late are settled by the failure ranges kept */
+    while(FMovementWaiter* waiter=newMovementWaiters.Peek()){
+        movementWaiters.Add(MoveTemp(*waiter));
+        newMovementWaiters.Pop();
+    }
+    for(int32 i=movementWaiters.Num()-1; i>=0; i--){
+        FMovementWaiter& waiter=movementWaiters[i];
+        const FFailedRange* failed=failedRanges.FindByPredicate([&waiter](const FFailedRange& range){
+            return waiter.ticket>range.fromTicket && waiter.ticket<=range.toTicket;
+        });
+        if(failed){
+            waiter.promise.SetValue(failed->code);
+        }else if(waiter.ticket<=completedTicket){
+            waiter.promise.SetValue(ECLIErrorCode::CLEAR);
+        }else{
+            continue;
+        }
+        movementWaiters.RemoveAtSwap(i);
+    }
+
+    /* Every range ends at or before issued, no waiter of theirs can show up anymore */
+    if(!bLateWaiters){
+        failedRanges.Reset();
+    }
+}
+
+/** Connection thread gone: nothing will complete anymore, every future left is failed */
+void FRemoteClientConnection::_SettleAll(){
+    FCommand cmd;
+    while(commands.Dequeue(cmd)){
+        _Reject(cmd, ECLIErrorCode::NoServerConnection);
+    }
+    if(queryPromise){
+        queryPromise->SetValue(ECLIErrorCode::NoServerConnection);
+        queryPromise.Reset();
+    }
+    while(FMovementWaiter* waiter=newMovementWaiters.Peek()){
+        movementWaiters.Add(MoveTemp(*waiter));
+        newMovementWaiters.Pop();
+    }
+    for(auto& waiter : movementWaiters){
+        waiter.promise.SetValue(ECLIErrorCode::NoServerConnection);
+    }
+    movementWaiters.Empty();
+    while(FPriorityMovement* movement=priorityMovements.Peek()){
+        movement->promise.SetValue(ECLIErrorCode::NoServerConnection);
+        priorityMovements.Pop();
+    }
+    _FailPriority(ECLIErrorCode::NoServerConnection);
+}
+
+/** Pushes as much of the queued frames as the transport takes */
+bool FRemoteClientConnection::_FlushSend(){
+    if(!transport){
+        return false;
+    }
+    while(outBuffer.Num()>0){
+        int32 bySent=0;
+        if(!transport->Send(outBuffer.GetData(), outBuffer.Num(), bySent)){
+            return false;
+        }
+        if(bySent<=0){
+            return true; /* Transport full, retried on the next poll */
+        }
+        outBuffer.RemoveAt(0, bySent, false);  /* Keep the reserved capacity */
+    }
+    return true;
+}
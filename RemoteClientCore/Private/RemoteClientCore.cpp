@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteClientCore.h"
+#include "RemoteClientBenchmark.h"
+#include "Modules/ModuleManager.h"
+#include "Misc/CommandLine.h"
+
+DEFINE_LOG_CATEGORY(LogRemoteClientSystem);
+
+class FRemoteClientCoreModule : public IModuleInterface
+{
+	public:
+
+		virtual void StartupModule() override{
+#if !UE_BUILD_SHIPPING
+			/* Opt-in, swapped once while the module loads instead of around every bench run */
+			if(FParse::Param(FCommandLine::Get(), TEXT("RemoteClientCountAllocs"))){
+				RemoteClientBench::InstallAllocationCounter();
+			}
+#endif
+		}
+};
+
+IMPLEMENT_MODULE(FRemoteClientCoreModule, RemoteClientCore);
@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteClientLog.h"
+#include "RemoteClientCore.h"
+#include "RemoteClientConnection.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Paths.h"
+
+constexpr int32 LOG_BUFFER_BYTES = 256*1024;        /* Reserved for each of the two buffers */
+constexpr int32 LOG_FLUSH_BYTES = 64*1024;          /* Wakes the writer before the periodic flush */
+constexpr int32 LOG_MAX_BUFFERED = 16*1024*1024;    /* Disk stalled, records are dropped past this */
+constexpr uint32 LOG_FLUSH_MS = 100;
+constexpr float REPLAY_POLL_S = 0.0001f;            /* As fast as possible: wait for the connection to take the previous movement */
+
+static_assert(PLATFORM_LITTLE_ENDIAN, "Log records are stored in memory order");
+
+FRemoteClientRecorder::FRemoteClientRecorder(const FString& InPath)
+    : path(InPath)
+{
+}
+
+FRemoteClientRecorder::~FRemoteClientRecorder(){
+    if(thread){
+        thread->Kill(true); /* Run() writes what is left on its way out */
+        delete thread;
+        thread = nullptr;
+    }
+    if(file){
+        file->Flush();
+        delete file;
+        file = nullptr;
+    }
+    if(wakeEvent){
+        FPlatformProcess::ReturnSynchEventToPool(wakeEvent);
+        wakeEvent = nullptr;
+    }
+}
+
+bool FRemoteClientRecorder::Start(){
+
+    IPlatformFile& platformFile=FPlatformFileManager::Get().GetPlatformFile();
+    platformFile.CreateDirectoryTree(*FPaths::GetPath(path));
+    file=platformFile.OpenWrite(*path);
+    if(!file){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Could not create the log %s"), *path);
+        return false;
+    }
+
+    FRemoteClientLogHeader header;
+    header.magic=FRemoteClientLogHeader::MAGIC;
+    header.version=FRemoteClientLogHeader::VERSION;
+    header.startUnixUs=(FDateTime::UtcNow()-FDateTime(1970, 1, 1)).GetTicks()/ETimespan::TicksPerMicrosecond;
+    file->Write((const uint8*)&header, sizeof(header));
+
+    front.Reserve(LOG_BUFFER_BYTES);
+    back.Reserve(LOG_BUFFER_BYTES);
+    startCycles=FPlatformTime::Cycles64();
+    wakeEvent=FPlatformProcess::GetSynchEventFromPool(false);
+    thread=FRunnableThread::Create(this, TEXT("RemoteClientRecorder"), 0, TPri_BelowNormal);
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Recording the command stream to %s"), *path);
+    return true;
+}
+
+void FRemoteClientRecorder::Stop(){
+    stopping=true;
+    wakeEvent->Trigger();
+}
+
+/** Caller thread: one copy into the front buffer, allocation free while the writer keeps up */
+void FRemoteClientRecorder::Record(ERemoteClientLogDirection Direction, EWireProtocol Protocol, TArrayView<const uint8> Frame){
+
+    FRemoteClientLogRecord record;
+    record.timeUs=(uint64)(FPlatformTime::GetSecondsPerCycle64()*(FPlatformTime::Cycles64()-startCycles)*1e6);
+    record.len=(uint16)Frame.Num();
+    record.direction=Direction;
+    record.protocol=Protocol;
+    record.reserved=0;
+    const int32 size=Align((int32)sizeof(record)+Frame.Num(), 8);
+
+    bool bWake;
+    {
+        FScopeLock scope(&lock);
+        if(front.Num()+size>LOG_MAX_BUFFERED){
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        uint8* dst=front.GetData()+front.AddUninitialized(size);
+        FMemory::Memcpy(dst, &record, sizeof(record));
+        FMemory::Memcpy(dst+sizeof(record), Frame.GetData(), Frame.Num());
+        FMemory::Memzero(dst+sizeof(record)+Frame.Num(), size-sizeof(record)-Frame.Num());
+        bWake=front.Num()>=LOG_FLUSH_BYTES;
+    }
+    if(bWake){
+        wakeEvent->Trigger();
+    }
+}
+
+uint32 FRemoteClientRecorder::Run(){
+
+    while(!stopping.load()){
+        wakeEvent->Wait(LOG_FLUSH_MS);
+        _WriteBack();
+    }
+    _WriteBack();
+    return 0;
+}
+
+void FRemoteClientRecorder::_WriteBack(){
+    {
+        FScopeLock scope(&lock);
+        Swap(front, back);  /* Both keep their allocation */
+    }
+    if(back.Num()>0){
+        if(!file->Write(back.GetData(), back.Num())){
+            UE_LOG(LogRemoteClientSystem, Warning, TEXT("Log write failed, %d bytes lost"), back.Num());
+        }
+        back.Reset();
+    }
+}
+
+FRemoteClientReplayer::FRemoteClientReplayer(FRemoteClientConnection& InConnection)
+    : connection(InConnection)
+{
+}
+
+FRemoteClientReplayer::~FRemoteClientReplayer(){
+    if(thread){
+        thread->Kill(true);
+        delete thread;
+        thread = nullptr;
+    }
+    /* The region has to go before its file */
+    mappedRegion.Reset();
+    mappedFile.Reset();
+}
+
+bool FRemoteClientReplayer::Start(const FString& Path, float InSpeed){
+
+    check(!thread);
+    mappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+    if(!mappedFile || mappedFile->GetFileSize()<(int64)sizeof(FRemoteClientLogHeader)){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Could not map the log %s"), *Path);
+        mappedFile.Reset();
+        return false;
+    }
+    mappedRegion.Reset(mappedFile->MapRegion(0, mappedFile->GetFileSize()));
+
+    FRemoteClientLogHeader header;
+    FMemory::Memcpy(&header, mappedRegion->GetMappedPtr(), sizeof(header));
+    if(header.magic!=FRemoteClientLogHeader::MAGIC || header.version!=FRemoteClientLogHeader::VERSION){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("%s is not a command stream log"), *Path);
+        mappedRegion.Reset();
+        mappedFile.Reset();
+        return false;
+    }
+
+    speed=FMath::Max(InSpeed, 0.f);
+    running=true;
+    thread=FRunnableThread::Create(this, TEXT("RemoteClientReplayer"), 0, TPri_AboveNormal);
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Replaying %s at %s"), *Path,
+        speed>0 ? *FString::Printf(TEXT("%.2fx"), speed) : TEXT("full speed"));
+    return true;
+}
+
+void FRemoteClientReplayer::Stop(){
+    stopping=true;
+}
+
+/** Walks the mapped records in place, only the movement frames are sent again: the replies come from the live server */
+uint32 FRemoteClientReplayer::Run(){
+
+    const uint8* data=mappedRegion->GetMappedPtr();
+    const int64 size=mappedRegion->GetMappedSize();
+    int64 at=sizeof(FRemoteClientLogHeader);
+
+    double start=0;
+    uint64 firstUs=0;
+    bool bFirst=true;
+    FServoInfo movements[MAX_SERVOS];
+    uint8 positions[MAX_SERVOS];
+
+    while(!stopping.load() && at+(int64)sizeof(FRemoteClientLogRecord)<=size){
+
+        FRemoteClientLogRecord record;
+        FMemory::Memcpy(&record, data+at, sizeof(record));
+        const uint8* frame=data+at+sizeof(record);
+        if(at+(int64)sizeof(record)+record.len>size){
+            break;  /* Cut short */
+        }
+        at+=Align((int64)sizeof(record)+record.len, 8);
+
+        uint32 mask=0;
+        if(record.direction!=ERemoteClientLogDirection::Sent
+            || !FRemoteClientProtocol::ParseMovement(record.protocol, MakeArrayView(frame, record.len), mask, positions)){
+            continue;
+        }
+
+        if(bFirst){
+            bFirst=false;
+            start=FPlatformTime::Seconds();
+            firstUs=record.timeUs;
+        }
+        if(speed>0){
+            const double due=start+(record.timeUs-firstUs)/1e6/speed;
+            for(double now=FPlatformTime::Seconds(); now<due && !stopping.load(); now=FPlatformTime::Seconds()){
+                FPlatformProcess::SleepNoStats((float)FMath::Min(due-now, 0.01));
+            }
+        }else{
+            /* One recorded order per order on the wire, as long as the window keeps up */
+            while(connection.HasPendingMovement() && !stopping.load()){
+                FPlatformProcess::SleepNoStats(REPLAY_POLL_S);
+            }
+        }
+
+        if(connection.GetErr()!=ECLIErrorCode::CLEAR){
+            UE_LOG(LogRemoteClientSystem, Warning, TEXT("Replay stopped by connection error %d"), (int32)connection.GetErr());
+            break;
+        }
+        int32 count=0;
+        for(uint32 bits=mask; bits; bits&=bits-1){
+            const uint32 i=FMath::CountTrailingZeros(bits);
+            movements[count++]=FServoInfo(i, positions[i]-1); /* Remove the +1 offset */
+        }
+        connection.SendMovement(TArrayView<const FServoInfo>(movements, count));
+        replayed++;
+    }
+
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Replay done, %d movements sent"), replayed.load());
+    running=false;
+    return 0;
+}
@@ -0,0 +1,353 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteClientProtocol.h"
+
+constexpr uint8 ID_SERVO_COUNT = 8;
+constexpr uint8 ID_SERVO_DATA_START = ID_SERVO_COUNT+2;
+constexpr int32 TEXT_FRAME_MIN_LEN = 12;  /* !s-XXXX-c-e! */
+
+static_assert(FRemoteClientProtocol::MAX_MOVEMENT_FRAME_LEN<=FRemoteClientProtocol::MAX_FRAME_LEN, "A movement frame must fit in a frame");
+static_assert(PLATFORM_LITTLE_ENDIAN, "Frame tags are matched as little endian words");
+
+/** Four type characters as the 32-bit word they load as, so a frame type is matched with one compare */
+static constexpr uint32 _Tag(const char (&type)[5]){
+    return (uint32)(uint8)type[0] | ((uint32)(uint8)type[1]<<8) | ((uint32)(uint8)type[2]<<16) | ((uint32)(uint8)type[3]<<24);
+}
+
+constexpr uint32 TAG_ACK = _Tag("_ACK");
+constexpr uint32 TAG_NACK = _Tag("NACK");
+constexpr uint32 TAG_iMCU = _Tag("iMCU");
+constexpr uint32 TAG_TLMD = _Tag("TLMD");
+constexpr uint32 TAG_UACK = _Tag("UACK");
+constexpr uint32 TAG_lMCU = _Tag("lMCU");
+constexpr uint32 TEXT_HEAD = (uint32)'!' | ((uint32)'s'<<8) | ((uint32)'-'<<16);   /* First 3 bytes */
+constexpr uint32 TEXT_TAIL = (uint32)'-' | ((uint32)'e'<<8) | ((uint32)'!'<<16);   /* Last 3 bytes */
+
+static FORCEINLINE uint32 _Load32(const uint8* p){
+    uint32 v;
+    FMemory::Memcpy(&v, p, 4);
+    return v;
+}
+
+static FORCEINLINE void _BinaryHeader(FFrameWriter& w, uint8 type, int32 payloadLen){
+    check(payloadLen<255);
+    w.Byte(FRemoteClientProtocol::BINARY_SYNC);
+    w.Byte((uint8)(payloadLen+1));
+    w.Byte(type);
+}
+
+void FRemoteClientProtocol::AppendLogin(TArray<uint8>& Out){
+    FFrameWriter w(Out, 32);
+    w.Literal("!s-Client_here-e!");
+}
+
+void FRemoteClientProtocol::AppendProtocolQuery(TArray<uint8>& Out, EWireProtocol Requested){
+    /* Always sent as text, the server switches (ACK) or refuses (NACK) */
+    FFrameWriter w(Out, TEXT_FRAME_MIN_LEN);
+    w.Literal("!s-PROT-");
+    w.Byte((uint8)Requested);
+    w.Literal("-e!");
+}
+
+void FRemoteClientProtocol::AppendSelectMCU(TArray<uint8>& Out, EWireProtocol Protocol, const FString& MCU_Name){
+    FTCHARToUTF8 name(*MCU_Name);
+    const int32 len=FMath::Min(name.Length(), MAX_MCU_NAME_LEN);
+    FFrameWriter w(Out, 11+len);
+    if(Protocol==EWireProtocol::Binary){
+        _BinaryHeader(w, BIN_sMCU, len);
+        w.Bytes((const uint8*)name.Get(), len);
+        return;
+    }
+    w.Literal("!s-sMCU-");
+    w.Bytes((const uint8*)name.Get(), len);
+    w.Literal("-e!");
+}
+
+void FRemoteClientProtocol::AppendInfoQuery(TArray<uint8>& Out, EWireProtocol Protocol){
+    FFrameWriter w(Out, TEXT_FRAME_MIN_LEN);
+    if(Protocol==EWireProtocol::Binary){
+        _BinaryHeader(w, BIN_iMCU_QUERY, 0);
+        return;
+    }
+    w.Literal("!s-iMCU-e!");
+}
+
+void FRemoteClientProtocol::AppendLimitsQuery(TArray<uint8>& Out, EWireProtocol Protocol){
+    FFrameWriter w(Out, TEXT_FRAME_MIN_LEN);
+    if(Protocol==EWireProtocol::Binary){
+        _BinaryHeader(w, BIN_lMCU_QUERY, 0);
+        return;
+    }
+    w.Literal("!s-lMCU-e!");
+}
+
+void FRemoteClientProtocol::AppendMovement(TArray<uint8>& Out, EWireProtocol Protocol, uint16 seq, bool bSequenced, uint32 mask, const uint8 (&positions)[MAX_SERVOS]){
+
+    const int32 count=FMath::CountBits(mask);
+    FFrameWriter w(Out, MAX_MOVEMENT_FRAME_LEN);
+
+    if(Protocol==EWireProtocol::Binary){
+        _BinaryHeader(w, BIN_SRVP, 2+4+count);
+        w.U16(seq);
+        w.U32(mask);
+        for(uint32 bits=mask; bits; bits&=bits-1){
+            w.Byte(positions[FMath::CountTrailingZeros(bits)]);
+        }
+        return;
+    }
+
+    if(bSequenced){
+        w.Literal("!s-SRVQ-");
+        w.Byte((uint8)count);
+        w.Byte('-');
+        w.Byte(TextSeqTag(seq));
+        w.Byte('-');
+    }else{
+        w.Literal("!s-SRVP-");
+        w.Byte((uint8)count);
+        w.Byte('-');
+    }
+    for(uint32 bits=mask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        w.Byte((uint8)(i+1)); // Add servoId offset
+        w.Byte(':');w.Byte(positions[i]);w.Byte('-');
+    }
+    w.Literal("e!");
+}
+
+void FRemoteClientProtocol::AppendPriorityMovement(TArray<uint8>& Out, EWireProtocol Protocol, uint8 flags, uint32 mask, const uint8 (&positions)[MAX_SERVOS]){
+
+    const int32 count=FMath::CountBits(mask);
+    FFrameWriter w(Out, MAX_MOVEMENT_FRAME_LEN);
+
+    if(Protocol==EWireProtocol::Binary){
+        _BinaryHeader(w, BIN_SRVU, 1+4+count);
+        w.Byte(flags);
+        w.U32(mask);
+        for(uint32 bits=mask; bits; bits&=bits-1){
+            w.Byte(positions[FMath::CountTrailingZeros(bits)]);
+        }
+        return;
+    }
+
+    w.Literal("!s-SRVU-");
+    w.Byte((uint8)count);
+    w.Byte('-');
+    w.Byte(flags);
+    w.Byte('-');
+    for(uint32 bits=mask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        w.Byte((uint8)(i+1)); // Add servoId offset
+        w.Byte(':');w.Byte(positions[i]);w.Byte('-');
+    }
+    w.Literal("e!");
+}
+
+void FRemoteClientProtocol::AppendRealTimeMode(TArray<uint8>& Out, EWireProtocol Protocol, bool bOn){
+    FFrameWriter w(Out, TEXT_FRAME_MIN_LEN);
+    if(Protocol==EWireProtocol::Binary){
+        _BinaryHeader(w, BIN_RTMD, 1);
+        w.Byte(bOn ? 1 : 0);
+        return;
+    }
+    w.Literal("!s-RTMD-");
+    w.Byte(bOn ? 1 : 0);
+    w.Literal("-e!");
+}
+
+void FRemoteClientProtocol::AppendSetpoint(TArray<uint8>& Out, EWireProtocol Protocol, uint16 seq, uint32 mask, const uint8 (&positions)[MAX_SERVOS]){
+
+    const int32 count=FMath::CountBits(mask);
+    FFrameWriter w(Out, MAX_MOVEMENT_FRAME_LEN+1);
+
+    if(Protocol==EWireProtocol::Binary){
+        _BinaryHeader(w, BIN_RTSP, 2+4+count);
+        w.U16(seq);
+        w.U32(mask);
+        for(uint32 bits=mask; bits; bits&=bits-1){
+            w.Byte(positions[FMath::CountTrailingZeros(bits)]);
+        }
+        return;
+    }
+
+    w.Literal("!s-RTSP-");
+    w.Byte((uint8)count);
+    w.Byte('-');
+    w.U16(seq);
+    w.Byte('-');
+    for(uint32 bits=mask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        w.Byte((uint8)(i+1)); // Add servoId offset
+        w.Byte(':');w.Byte(positions[i]);w.Byte('-');
+    }
+    w.Literal("e!");
+}
+
+void FRemoteClientProtocol::AppendTelemetryRequest(TArray<uint8>& Out, EWireProtocol Protocol, uint16 RateHz){
+    FFrameWriter w(Out, TEXT_FRAME_MIN_LEN+1);
+    if(Protocol==EWireProtocol::Binary){
+        _BinaryHeader(w, BIN_TLMS, 2);
+        w.U16(RateHz);
+        return;
+    }
+    w.Literal("!s-TLMS-");
+    w.U16(RateHz);
+    w.Literal("-e!");
+}
+
+bool FRemoteClientProtocol::ParseReply(EWireProtocol Protocol, TArrayView<const uint8> frame, FServerReply& Out){
+    Out=FServerReply();
+    return Protocol==EWireProtocol::Binary ? _ParseBinary(frame, Out) : _ParseText(frame, Out);
+}
+
+bool FRemoteClientProtocol::ParseMovement(EWireProtocol Protocol, TArrayView<const uint8> frame, uint32& OutMask, uint8 (&OutPositions)[MAX_SERVOS]){
+
+    OutMask=0;
+    const uint8* f=frame.GetData();
+    const int32 len=frame.Num();
+
+    if(Protocol==EWireProtocol::Binary){
+        /* [sync][len][SRVP][seq:2][mask:4][positions] */
+        if(len<BINARY_HEADER_LEN+6 || f[0]!=BINARY_SYNC || f[1]+2!=len || f[2]!=BIN_SRVP){
+            return false;
+        }
+        const uint32 mask=(uint32)f[5]|((uint32)f[6]<<8)|((uint32)f[7]<<16)|((uint32)f[8]<<24);
+        if(FMath::CountBits(mask)!=len-9){
+            return false;
+        }
+        const uint8* p=f+9;
+        for(uint32 bits=mask; bits; bits&=bits-1){
+            OutPositions[FMath::CountTrailingZeros(bits)]=*p++;
+        }
+        OutMask=mask;
+        return true;
+    }
+
+    if(len<TEXT_FRAME_MIN_LEN || (_Load32(f)&0x00FFFFFF)!=TEXT_HEAD){
+        return false;
+    }
+    const uint32 tag=_Load32(f+3);
+    if(tag!=_Tag("SRVP") && tag!=_Tag("SRVQ")){
+        return false;
+    }
+    const int32 dataStart=tag==_Tag("SRVQ") ? 12 : 10;  /* !s-SRVQ-c-q- / !s-SRVP-c- */
+    const int32 count=f[ID_SERVO_COUNT];
+    if(len!=dataStart+4*count+2){
+        return false;
+    }
+    for(int32 i=0; i<count; i++){
+        const uint8* d=f+dataStart+4*i;  /* id+1 ':' pos '-' */
+        if(d[0]<1 || d[0]>MAX_SERVOS){
+            return false;
+        }
+        OutPositions[d[0]-1]=d[2];
+        OutMask|=1u<<(d[0]-1);
+    }
+    return true;
+}
+
+/** Single pass classifier: envelope & type are checked as whole words, then the fields of that type are read */
+bool FRemoteClientProtocol::_ParseText(TArrayView<const uint8> frame, FServerReply& Out){
+
+    const int32 len=frame.Num();
+    if(len<TEXT_FRAME_MIN_LEN){
+        return false;
+    }
+    const uint8* f=frame.GetData();
+    if((_Load32(f)&0x00FFFFFF)!=TEXT_HEAD || (_Load32(f+len-4)>>8)!=TEXT_TAIL || f[7]!='-'){
+        return false;
+    }
+
+    switch(_Load32(f+3)){
+        case TAG_ACK:
+        case TAG_NACK:
+            /* !s-_ACK-c-e! / !s-NACK-x-e! */
+            if(len!=TEXT_FRAME_MIN_LEN){
+                return false;
+            }
+            Out.type=f[3]=='_' ? EServerReply::ACK : EServerReply::NACK;
+            Out.code=f[ID_SERVO_COUNT];
+            return true;
+
+        case TAG_UACK:
+            /* !s-UACK-r-e! */
+            if(len!=TEXT_FRAME_MIN_LEN){
+                return false;
+            }
+            Out.type=EServerReply::Priority;
+            Out.code=f[ID_SERVO_COUNT];
+            return true;
+
+        case TAG_iMCU:
+        case TAG_TLMD:
+            Out.type=f[3]=='i' ? EServerReply::iMCU : EServerReply::Telemetry;
+            Out.servoCount=f[ID_SERVO_COUNT];
+            Out.servoData=f+ID_SERVO_DATA_START;
+            Out.servoDataLen=len-ID_SERVO_DATA_START;
+            return true;
+
+        case TAG_lMCU:
+            Out.type=EServerReply::Limits;
+            Out.servoCount=f[ID_SERVO_COUNT];
+            Out.servoData=f+ID_SERVO_DATA_START;
+            Out.servoDataLen=len-ID_SERVO_DATA_START;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool FRemoteClientProtocol::_ParseBinary(TArrayView<const uint8> frame, FServerReply& Out){
+
+    if(frame.Num()<BINARY_HEADER_LEN || frame[0]!=BINARY_SYNC || frame[1]+2!=frame.Num()){
+        return false;
+    }
+    const uint8* payload=frame.GetData()+BINARY_HEADER_LEN;
+    const int32 payloadLen=frame.Num()-BINARY_HEADER_LEN;
+
+    switch(frame[2]){
+        case BIN_ACK:
+        case BIN_NACK:
+            if(payloadLen!=3){
+                return false;
+            }
+            Out.type=frame[2]==BIN_ACK ? EServerReply::ACK : EServerReply::NACK;
+            Out.seq=(uint16)(payload[0]|(payload[1]<<8));
+            Out.stage=frame[2]==BIN_ACK ? payload[2] : 0;
+            Out.code=payload[2];
+            return true;
+
+        case BIN_UACK:
+            if(payloadLen!=1){
+                return false;
+            }
+            Out.type=EServerReply::Priority;
+            Out.code=payload[0];
+            return true;
+
+        case BIN_iMCU:
+        case BIN_TLMD:
+            if(payloadLen<1){
+                return false;
+            }
+            Out.type=frame[2]==BIN_iMCU ? EServerReply::iMCU : EServerReply::Telemetry;
+            Out.servoCount=payload[0];
+            Out.servoData=payload+1;
+            Out.servoDataLen=payloadLen-1;
+            return true;
+
+        case BIN_lMCU:
+            if(payloadLen<1){
+                return false;
+            }
+            Out.type=EServerReply::Limits;
+            Out.servoCount=payload[0];
+            Out.servoData=payload+1;
+            Out.servoDataLen=payloadLen-1;
+            return true;
+
+        default:
+            return false;
+    }
+}
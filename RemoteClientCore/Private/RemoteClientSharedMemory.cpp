@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteClientSharedMemory.h"
+#include "RemoteClientCore.h"
+
+constexpr int32 SPIN_YIELDS = 200;          /* Waits spin on the ring this many times before they start sleeping */
+constexpr float SPIN_SLEEP_S = 0.0001f;
+
+static_assert((FSharedMemoryRing::CAPACITY&(FSharedMemoryRing::CAPACITY-1))==0, "Ring indices are masked");
+
+static const uint32 SHARED_ACCESS = (uint32)FPlatformMemory::ESharedMemoryAccess::Read | (uint32)FPlatformMemory::ESharedMemoryAccess::Write;
+
+int32 FSharedMemoryRing::Write(const uint8* Src, int32 Len){
+
+    const uint32 h=head.load(std::memory_order_relaxed);
+    const uint32 t=tail.load(std::memory_order_acquire);
+    const int32 n=FMath::Min<int32>(Len, CAPACITY-(h-t));
+    if(n<=0){
+        return 0;
+    }
+    const uint32 at=h&(CAPACITY-1);
+    const int32 first=FMath::Min<int32>(n, CAPACITY-at);
+    FMemory::Memcpy(data+at, Src, first);
+    FMemory::Memcpy(data, Src+first, n-first);
+    head.store(h+n, std::memory_order_release);
+    return n;
+}
+
+int32 FSharedMemoryRing::Read(uint8* Dst, int32 MaxLen){
+
+    const uint32 t=tail.load(std::memory_order_relaxed);
+    const uint32 h=head.load(std::memory_order_acquire);
+    const int32 n=FMath::Min<int32>(MaxLen, h-t);
+    if(n<=0){
+        return 0;
+    }
+    const uint32 at=t&(CAPACITY-1);
+    const int32 first=FMath::Min<int32>(n, CAPACITY-at);
+    FMemory::Memcpy(Dst, data+at, first);
+    FMemory::Memcpy(Dst+first, data, n-first);
+    tail.store(t+n, std::memory_order_release);
+    return n;
+}
+
+FString FSharedMemoryChannel::GetName(int32 Port){
+    return FString::Printf(TEXT("RemoteClient_%d"), Port);
+}
+
+/** Spins on Ready, then sleeps in short steps until Wait is over. The sender never has to signal anything */
+template<typename TReady>
+static bool _SpinWait(FTimespan Wait, TReady&& Ready){
+    const double deadline=FPlatformTime::Seconds()+Wait.GetTotalSeconds();
+    for(int32 spins=0; ; spins++){
+        if(Ready()){
+            return true;
+        }
+        if(FPlatformTime::Seconds()>=deadline){
+            return false;
+        }
+        if(spins<SPIN_YIELDS){
+            FPlatformProcess::YieldThread();
+        }else{
+            FPlatformProcess::SleepNoStats(SPIN_SLEEP_S);
+        }
+    }
+}
+
+FSharedMemoryTransport::~FSharedMemoryTransport(){
+    if(region){
+        if(channel && (session==0 || channel->session.load(std::memory_order_acquire)==session)){
+            channel->clientState.store(FSharedMemoryChannel::STATE_CLOSED, std::memory_order_release);
+        }
+        FPlatformMemory::UnmapNamedSharedMemoryRegion(region);
+        region = nullptr;
+        channel = nullptr;
+    }
+}
+
+bool FSharedMemoryTransport::Connect(const FString& Address, int32 Port){
+
+    check(!region);
+    region=FPlatformMemory::MapNamedSharedMemoryRegion(FSharedMemoryChannel::GetName(Port), false, SHARED_ACCESS, sizeof(FSharedMemoryChannel));
+    if(!region){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("No local server on shared memory channel %d"), Port);
+        return false;
+    }
+    FSharedMemoryChannel* shared=(FSharedMemoryChannel*)region->GetAddress();
+    uint32 expected=FSharedMemoryChannel::STATE_NONE;
+    if(shared->magic!=FSharedMemoryChannel::MAGIC || shared->version!=FSharedMemoryChannel::VERSION
+        || shared->serverState.load(std::memory_order_acquire)!=FSharedMemoryChannel::STATE_OPEN
+        || !shared->clientState.compare_exchange_strong(expected, FSharedMemoryChannel::STATE_OPEN)){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Shared memory channel %d is not accepting clients"), Port);
+        FPlatformMemory::UnmapNamedSharedMemoryRegion(region);
+        region = nullptr;
+        return false;
+    }
+    channel=shared;
+    return true;
+}
+
+ETransportConnectState FSharedMemoryTransport::PollConnect(FTimespan Wait){
+    const bool bAnswered=_SpinWait(Wait, [this](){
+        return channel->serverState.load(std::memory_order_acquire)!=FSharedMemoryChannel::STATE_OPEN;
+    });
+    if(!bAnswered){
+        return ETransportConnectState::Pending;
+    }
+    if(channel->serverState.load(std::memory_order_acquire)!=FSharedMemoryChannel::STATE_SESSION){
+        return ETransportConnectState::Failed;
+    }
+    session=channel->session.load(std::memory_order_acquire);
+    channel->clientState.store(FSharedMemoryChannel::STATE_SESSION, std::memory_order_release);
+    return ETransportConnectState::Connected;
+}
+
+bool FSharedMemoryTransport::_IsServerGone() const{
+    return channel->serverState.load(std::memory_order_acquire)!=FSharedMemoryChannel::STATE_SESSION
+        || channel->session.load(std::memory_order_relaxed)!=session;
+}
+
+bool FSharedMemoryTransport::WaitForRead(FTimespan Wait){
+    return _SpinWait(Wait, [this](){ return !channel->toClient.IsEmpty() || _IsServerGone(); });
+}
+
+bool FSharedMemoryTransport::Send(const uint8* Data, int32 Len, int32& OutSent){
+    OutSent=0;
+    if(_IsServerGone()){
+        return false;
+    }
+    OutSent=channel->toServer.Write(Data, Len);
+    return true;
+}
+
+bool FSharedMemoryTransport::Recv(uint8* Data, int32 MaxLen, int32& OutRead){
+    OutRead=channel->toClient.Read(Data, MaxLen);
+    /* What the server sent before leaving is still delivered */
+    return OutRead>0 || !_IsServerGone();
+}
+
+/** Accepted session, server side */
+class FSharedMemoryServerTransport final : public IRemoteClientTransport
+{
+	public:
+
+		explicit FSharedMemoryServerTransport(FSharedMemoryChannel* InChannel) : channel(InChannel) {}
+
+		virtual ~FSharedMemoryServerTransport(){
+			/* Back to listening, the next client may claim the channel */
+			channel->clientState.store(FSharedMemoryChannel::STATE_NONE, std::memory_order_release);
+			channel->serverState.store(FSharedMemoryChannel::STATE_OPEN, std::memory_order_release);
+		}
+
+		virtual bool Connect(const FString& Address, int32 Port) override { return false; }
+		virtual ETransportConnectState PollConnect(FTimespan Wait) override { return ETransportConnectState::Connected; }
+
+		virtual bool WaitForRead(FTimespan Wait) override {
+			return _SpinWait(Wait, [this](){ return !channel->toServer.IsEmpty() || _IsClientGone(); });
+		}
+
+		virtual bool Send(const uint8* Data, int32 Len, int32& OutSent) override {
+			OutSent=0;
+			if(_IsClientGone()){
+				return false;
+			}
+			OutSent=channel->toClient.Write(Data, Len);
+			return true;
+		}
+
+		virtual bool Recv(uint8* Data, int32 MaxLen, int32& OutRead) override {
+			OutRead=channel->toServer.Read(Data, MaxLen);
+			return OutRead>0 || !_IsClientGone();
+		}
+
+	private:
+
+		FSharedMemoryChannel* channel;
+
+		bool _IsClientGone() const { return channel->clientState.load(std::memory_order_acquire)==FSharedMemoryChannel::STATE_CLOSED; }
+};
+
+FSharedMemoryListener::~FSharedMemoryListener(){
+    if(region){
+        channel->serverState.store(FSharedMemoryChannel::STATE_CLOSED, std::memory_order_release);
+        FPlatformMemory::UnmapNamedSharedMemoryRegion(region);
+        region = nullptr;
+        channel = nullptr;
+    }
+}
+
+bool FSharedMemoryListener::Listen(int32 Port){
+
+    check(!region);
+    region=FPlatformMemory::MapNamedSharedMemoryRegion(FSharedMemoryChannel::GetName(Port), true, SHARED_ACCESS, sizeof(FSharedMemoryChannel));
+    if(!region){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Could not create shared memory channel %d"), Port);
+        return false;
+    }
+    channel=new(region->GetAddress()) FSharedMemoryChannel;
+    channel->magic=FSharedMemoryChannel::MAGIC;
+    channel->version=FSharedMemoryChannel::VERSION;
+    channel->session.store(0, std::memory_order_relaxed);
+    channel->clientState.store(FSharedMemoryChannel::STATE_NONE, std::memory_order_relaxed);
+    channel->serverState.store(FSharedMemoryChannel::STATE_OPEN, std::memory_order_release);
+    return true;
+}
+
+TUniquePtr<IRemoteClientTransport> FSharedMemoryListener::Accept(FTimespan Wait){
+
+    const bool bClient=_SpinWait(Wait, [this](){
+        return channel->clientState.load(std::memory_order_acquire)==FSharedMemoryChannel::STATE_OPEN;
+    });
+    if(!bClient || channel->serverState.load(std::memory_order_relaxed)!=FSharedMemoryChannel::STATE_OPEN){
+        return nullptr;
+    }
+    /* The client only touches the rings once the session is published */
+    for(FSharedMemoryRing* ring : {&channel->toServer, &channel->toClient}){
+        ring->head.store(0, std::memory_order_relaxed);
+        ring->tail.store(0, std::memory_order_relaxed);
+    }
+    channel->session.fetch_add(1, std::memory_order_relaxed);
+    channel->serverState.store(FSharedMemoryChannel::STATE_SESSION, std::memory_order_release);
+    return MakeUnique<FSharedMemoryServerTransport>(channel);
+}
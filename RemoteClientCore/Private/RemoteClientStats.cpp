@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteClientStats.h"
+#include "Trace/Trace.inl"
+#include "ProfilingDebugging/CountersTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(RemoteClientChannel)
+
+UE_TRACE_EVENT_BEGIN(RemoteClient, PhaseLatency)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, LatencyUs)
+	UE_TRACE_EVENT_FIELD(uint16, Seq)
+	UE_TRACE_EVENT_FIELD(uint8, Phase)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(RemoteClient, Nack)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint8, Code)
+UE_TRACE_EVENT_END()
+
+TRACE_DECLARE_INT_COUNTER(RemoteClientOrdersInFlight, TEXT("RemoteClient/OrdersInFlight"));
+TRACE_DECLARE_INT_COUNTER(RemoteClientOrdersCompleted, TEXT("RemoteClient/OrdersCompleted"));
+TRACE_DECLARE_INT_COUNTER(RemoteClientCoalescedWrites, TEXT("RemoteClient/CoalescedWrites"));
+
+static uint64 _CyclesToUs(uint64 cycles){
+    return (uint64)(FPlatformTime::GetSecondsPerCycle64()*cycles*1000000.0);
+}
+
+/* ---- FLatencyHistogram ---- */
+
+uint32 FLatencyHistogram::_BucketOf(uint32 us){
+    if(us<SubBuckets){
+        return us;
+    }
+    const uint32 e=FMath::FloorLog2(us);
+    const uint32 sub=(us>>(e-SubBucketBits))&(SubBuckets-1);
+    return (e-SubBucketBits+1)*SubBuckets+sub;
+}
+
+uint32 FLatencyHistogram::_UpperBoundOf(uint32 bucket){
+    if(bucket<2*SubBuckets){
+        return bucket;
+    }
+    const uint32 e=bucket/SubBuckets+SubBucketBits-1;
+    const uint32 sub=bucket&(SubBuckets-1);
+    const uint64 low=(uint64)(SubBuckets+sub)<<(e-SubBucketBits);
+    return (uint32)FMath::Min<uint64>(low+(1ull<<(e-SubBucketBits))-1, MAX_uint32);
+}
+
+void FLatencyHistogram::Record(uint64 Microseconds){
+    const uint32 us=(uint32)FMath::Min<uint64>(Microseconds, MAX_uint32);
+    buckets[_BucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumUs.fetch_add(us, std::memory_order_relaxed);
+
+    uint64 prevMax=maxUs.load(std::memory_order_relaxed);
+    while(us>prevMax && !maxUs.compare_exchange_weak(prevMax, us, std::memory_order_relaxed)){}
+}
+
+void FLatencyHistogram::Reset(){
+    for(auto& b : buckets){
+        b.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sumUs.store(0, std::memory_order_relaxed);
+    maxUs.store(0, std::memory_order_relaxed);
+}
+
+void FLatencyHistogram::GetInfo(FRemoteClientLatencyInfo& Out) const{
+
+    /* Relaxed copy, samples recorded meanwhile may be partially seen */
+    uint32 copy[NumBuckets];
+    uint64 total=0;
+    for(uint32 i=0; i<NumBuckets; i++){
+        copy[i]=buckets[i].load(std::memory_order_relaxed);
+        total+=copy[i];
+    }
+
+    Out=FRemoteClientLatencyInfo();
+    Out.Count=(int64)total;
+    if(total==0){
+        return;
+    }
+    Out.MeanMs=(float)(sumUs.load(std::memory_order_relaxed)/1000.0/FMath::Max<uint64>(1, count.load(std::memory_order_relaxed)));
+    Out.MaxMs=maxUs.load(std::memory_order_relaxed)/1000.f;
+
+    /* Each percentile is reported as the upper bound of the bucket reaching it */
+    const uint64 ranks[3]={(total*50+99)/100, (total*90+99)/100, (total*99+99)/100};
+    float* outs[3]={&Out.P50Ms, &Out.P90Ms, &Out.P99Ms};
+    uint64 seen=0;
+    int32 next=0;
+    for(uint32 i=0; i<NumBuckets && next<3; i++){
+        seen+=copy[i];
+        while(next<3 && seen>=ranks[next]){
+            *outs[next++]=FMath::Min<float>(_UpperBoundOf(i)/1000.f, Out.MaxMs);
+        }
+    }
+}
+
+uint64 FLatencyHistogram::GetPercentileUs(double Percentile) const{
+
+    uint64 total=0;
+    for(const auto& b : buckets){
+        total+=b.load(std::memory_order_relaxed);
+    }
+    if(total==0){
+        return 0;
+    }
+
+    const uint64 rank=FMath::Max<uint64>(1, (uint64)FMath::CeilToDouble(total*Percentile/100.0));
+    uint64 seen=0;
+    for(uint32 i=0; i<NumBuckets; i++){
+        seen+=buckets[i].load(std::memory_order_relaxed);
+        if(seen>=rank){
+            return FMath::Min<uint64>(_UpperBoundOf(i), maxUs.load(std::memory_order_relaxed));
+        }
+    }
+    return maxUs.load(std::memory_order_relaxed);
+}
+
+/* ---- FRemoteClientStats ---- */
+
+void FRemoteClientStats::Reset(){
+    for(auto& h : phases){
+        h.Reset();
+    }
+    ordersSent.store(0, std::memory_order_relaxed);
+    ordersCompleted.store(0, std::memory_order_relaxed);
+    servoWrites.store(0, std::memory_order_relaxed);
+    coalescedWrites.store(0, std::memory_order_relaxed);
+    deadbandDrops.store(0, std::memory_order_relaxed);
+    for(auto& n : nacks){
+        n.store(0, std::memory_order_relaxed);
+    }
+    resetCycles.store(FPlatformTime::Cycles64(), std::memory_order_relaxed);
+}
+
+void FRemoteClientStats::RecordWrites(int32 Servos, int32 Coalesced){
+    servoWrites.fetch_add(Servos, std::memory_order_relaxed);
+    if(Coalesced>0){
+        coalescedWrites.fetch_add(Coalesced, std::memory_order_relaxed);
+        TRACE_COUNTER_ADD(RemoteClientCoalescedWrites, Coalesced);
+    }
+}
+
+void FRemoteClientStats::RecordPhase(ERemoteClientPhase Phase, uint64 StartCycles, uint64 EndCycles, uint16 Seq){
+    if(StartCycles==0 || EndCycles<StartCycles){
+        return;
+    }
+    const uint64 us=_CyclesToUs(EndCycles-StartCycles);
+    phases[(int32)Phase].Record(us);
+
+    const uint8 phaseId=(uint8)Phase;
+    UE_TRACE_LOG(RemoteClient, PhaseLatency, RemoteClientChannel)
+        << PhaseLatency.Cycle(EndCycles)
+        << PhaseLatency.LatencyUs((uint32)FMath::Min<uint64>(us, MAX_uint32))
+        << PhaseLatency.Seq(Seq)
+        << PhaseLatency.Phase(phaseId);
+}
+
+void FRemoteClientStats::RecordOrderSent(uint16 Seq, uint64 QueuedCycles, uint64 SentCycles){
+    ordersSent.fetch_add(1, std::memory_order_relaxed);
+    RecordPhase(ERemoteClientPhase::Queue, QueuedCycles, SentCycles, Seq);
+}
+
+void FRemoteClientStats::RecordOrderCompleted(uint16 Seq, uint64 QueuedCycles, uint64 ServerAckCycles, uint64 McuAckCycles){
+    const uint64 completed=ordersCompleted.fetch_add(1, std::memory_order_relaxed)+1;
+    TRACE_COUNTER_SET(RemoteClientOrdersCompleted, (int64)completed);
+    RecordPhase(ERemoteClientPhase::McuAck, ServerAckCycles, McuAckCycles, Seq);
+    RecordPhase(ERemoteClientPhase::Order, QueuedCycles, McuAckCycles, Seq);
+}
+
+void FRemoteClientStats::RecordNack(uint8 Code){
+    nacks[Code].fetch_add(1, std::memory_order_relaxed);
+
+    UE_TRACE_LOG(RemoteClient, Nack, RemoteClientChannel)
+        << Nack.Cycle(FPlatformTime::Cycles64())
+        << Nack.Code(Code);
+}
+
+void FRemoteClientStats::RecordInFlight(int32 Orders){
+    TRACE_COUNTER_SET(RemoteClientOrdersInFlight, Orders);
+}
+
+void FRemoteClientStats::RecordDeadbandDrops(int32 Servos){
+    deadbandDrops.fetch_add(Servos, std::memory_order_relaxed);
+}
+
+void FRemoteClientStats::GetInfo(FRemoteClientStatsInfo& Out) const{
+
+    FRemoteClientLatencyInfo* outs[(int32)ERemoteClientPhase::Num]={
+        &Out.Queue, &Out.ServerAck, &Out.McuAck, &Out.Order, &Out.Connect, &Out.SelectMCU, &Out.MCUInfo, &Out.Startup, &Out.Priority
+    };
+    for(int32 i=0; i<(int32)ERemoteClientPhase::Num; i++){
+        phases[i].GetInfo(*outs[i]);
+    }
+
+    Out.OrdersSent=(int64)ordersSent.load(std::memory_order_relaxed);
+    Out.OrdersCompleted=(int64)ordersCompleted.load(std::memory_order_relaxed);
+    Out.ServoWrites=(int64)servoWrites.load(std::memory_order_relaxed);
+    Out.CoalescedWrites=(int64)coalescedWrites.load(std::memory_order_relaxed);
+    Out.DeadbandDrops=(int64)deadbandDrops.load(std::memory_order_relaxed);
+
+    const double elapsed=FPlatformTime::GetSecondsPerCycle64()*(FPlatformTime::Cycles64()-resetCycles.load(std::memory_order_relaxed));
+    Out.OrdersPerSecond=elapsed>0 ? (float)(Out.OrdersCompleted/elapsed) : 0.f;
+
+    Out.NacksByCode.Reset();
+    for(int32 code=0; code<256; code++){
+        const uint64 n=nacks[code].load(std::memory_order_relaxed);
+        if(n>0){
+            Out.NacksByCode.Add(ECLIErrorCode(code), (int64)n);
+        }
+    }
+}
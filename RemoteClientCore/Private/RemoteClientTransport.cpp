@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteClientTransport.h"
+#include "RemoteClientCore.h"
+#include "RemoteClientSharedMemory.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+#include "IPAddress.h"
+
+TUniquePtr<IRemoteClientTransport> IRemoteClientTransport::Create(ERemoteClientTransport Type){
+    switch(Type){
+        case ERemoteClientTransport::SharedMemory:
+            return MakeUnique<FSharedMemoryTransport>();
+        default:
+            return MakeUnique<FTcpTransport>();
+    }
+}
+
+FTcpTransport::FTcpTransport(FSocket* InAccepted)
+    : sck(InAccepted)
+{
+    sck->SetNonBlocking(true);
+    sck->SetNoDelay(true);
+}
+
+FTcpTransport::~FTcpTransport(){
+    if(sck){
+        sck->Close();
+        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(sck);
+        sck = nullptr;
+    }
+}
+
+bool FTcpTransport::Connect(const FString& Address, int32 Port){
+
+    check(!sck);
+    ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+    TSharedPtr<FInternetAddr> srvAddr = SocketSubsystem->CreateInternetAddr();
+    bool bIsValid;
+    srvAddr->SetIp(*Address, bIsValid);
+    srvAddr->SetPort(Port);
+
+    if (!bIsValid){
+        /* Invalid ip:port address */
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Invalid Server ip:port address"));
+        return false;
+    }
+
+    sck = SocketSubsystem->CreateSocket(NAME_Stream, TEXT("Server socket"), false);
+
+    /* The socket is only ever polled by the connection thread, the connect itself does not block either */
+    sck->SetNonBlocking(true);
+    sck->SetReuseAddr(true);
+    sck->SetNoDelay(true);
+
+    if(!sck->Connect(*srvAddr)){
+        const ESocketErrors sckErr=SocketSubsystem->GetLastErrorCode();
+        if(sckErr!=SE_EWOULDBLOCK && sckErr!=SE_EINPROGRESS){
+            /* Connection refused */
+            UE_LOG(LogRemoteClientSystem, Error, TEXT("Server connection refused"));
+            return false;
+        }
+    }
+    return true;
+}
+
+ETransportConnectState FTcpTransport::PollConnect(FTimespan Wait){
+    if(!sck->Wait(ESocketWaitConditions::WaitForWrite, Wait)){
+        return ETransportConnectState::Pending;
+    }
+    switch(sck->GetConnectionState()){
+        case SCS_Connected:
+            return ETransportConnectState::Connected;
+        case SCS_ConnectionError:
+            UE_LOG(LogRemoteClientSystem, Error, TEXT("Server connection refused"));
+            return ETransportConnectState::Failed;
+        default:
+            return ETransportConnectState::Pending;
+    }
+}
+
+bool FTcpTransport::WaitForRead(FTimespan Wait){
+    return sck->Wait(ESocketWaitConditions::WaitForRead, Wait);
+}
+
+bool FTcpTransport::Send(const uint8* Data, int32 Len, int32& OutSent){
+    OutSent=0;
+    if(!sck->Send(Data, Len, OutSent)){
+        /* Socket buffer full, retried on the next poll */
+        OutSent=0;
+        return ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode()==SE_EWOULDBLOCK;
+    }
+    return true;
+}
+
+bool FTcpTransport::Recv(uint8* Data, int32 MaxLen, int32& OutRead){
+    /* Would block: true with nothing read. Closed by the server or failed: false */
+    return sck->Recv(Data, MaxLen, OutRead);
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteCommandChannel.h"
+#include "RemoteClientConnection.h"
+#include "ServoPose.h"
+
+/* Every call pins the connection for its own duration only */
+
+bool FRemoteCommandChannel::Send(TArrayView<const FServoInfo> servoMovements) const{
+    const TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe> pinned=connection.Pin();
+    return pinned && pinned->SendMovement(servoMovements);
+}
+
+bool FRemoteCommandChannel::Send(uint32 mask, const uint8 (&positions)[MAX_SERVOS]) const{
+    const TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe> pinned=connection.Pin();
+    return pinned && pinned->SendMovement(mask, positions);
+}
+
+bool FRemoteCommandChannel::SendPose(FServoPoseConverter& Converter, const float (&AnglesDeg)[MAX_SERVOS], uint32 mask) const{
+    const TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe> pinned=connection.Pin();
+    if(!pinned){
+        return false;
+    }
+    uint8 wire[MAX_SERVOS];
+    const uint32 changed=Converter.Convert(AnglesDeg, mask, wire);
+    if(changed==0){
+        return true;
+    }
+    if(!pinned->SendWireMovement(changed, wire)){
+        Converter.Invalidate();
+        return false;
+    }
+    return true;
+}
+
+TFuture<ECLIErrorCode> FRemoteCommandChannel::SendAsync(TArrayView<const FServoInfo> servoMovements) const{
+    const TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe> pinned=connection.Pin();
+    if(!pinned){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::NoServerConnection).GetFuture();
+    }
+    return pinned->SendMovementAsync(servoMovements);
+}
+
+TFuture<ECLIErrorCode> FRemoteCommandChannel::SendAsync(uint32 mask, const uint8 (&positions)[MAX_SERVOS]) const{
+    const TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe> pinned=connection.Pin();
+    if(!pinned){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::NoServerConnection).GetFuture();
+    }
+    return pinned->SendMovementAsync(mask, positions);
+}
+
+ECLIErrorCode FRemoteCommandChannel::GetErr() const{
+    const TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe> pinned=connection.Pin();
+    return pinned ? pinned->GetErr() : ECLIErrorCode::NoServerConnection;
+}
+
+bool FRemoteCommandChannel::ReadServoPositions(FServoPositionSnapshot& InOutSnapshot) const{
+    const TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe> pinned=connection.Pin();
+    return pinned && pinned->ReadServoPositions(InOutSnapshot);
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteMCUInfoCache.h"
+#include "RemoteClientCore.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Async/Async.h"
+
+/* [magic:4][version][count][positions: count] */
+constexpr uint32 CACHE_MAGIC = 0x49434D52;  /* "RMCI" */
+constexpr uint8 CACHE_VERSION = 1;
+constexpr int32 CACHE_HEADER_LEN = 6;
+
+/* Same header, then [min: count][max: count] */
+constexpr uint32 LIMITS_MAGIC = 0x4C434D52; /* "RMCL" */
+
+FString FRemoteMCUInfoCache::_Path(const FString& MCU_Name, const TCHAR* Extension){
+    return FPaths::ProjectSavedDir()/TEXT("RemoteClient")/TEXT("MCUInfo")/FPaths::MakeValidFileName(MCU_Name)+Extension;
+}
+
+void FRemoteMCUInfoCache::_Write(const FString& Path, TArray<uint8>&& Data){
+    AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [path=Path, data=MoveTemp(Data)](){
+        if(!FFileHelper::SaveArrayToFile(data, *path)){
+            UE_LOG(LogRemoteClientSystem, Warning, TEXT("Could not write the MCU info cache %s"), *path);
+        }
+    });
+}
+
+bool FRemoteMCUInfoCache::Load(const FString& MCU_Name, uint8 (&OutPositions)[MAX_SERVOS], uint8& OutCount){
+
+    TArray<uint8> data;
+    if(MCU_Name.IsEmpty() || !FFileHelper::LoadFileToArray(data, *_Path(MCU_Name, TEXT(".bin")), FILEREAD_Silent)){
+        return false;
+    }
+
+    uint32 magic=0;
+    if(data.Num()>=CACHE_HEADER_LEN){
+        FMemory::Memcpy(&magic, data.GetData(), 4);
+    }
+    const uint8 count=data.Num()>=CACHE_HEADER_LEN ? data[5] : 0;
+    if(magic!=CACHE_MAGIC || data[4]!=CACHE_VERSION || count==0 || count>MAX_SERVOS || data.Num()!=CACHE_HEADER_LEN+count){
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Ignoring the invalid MCU info cache of %s"), *MCU_Name);
+        return false;
+    }
+    for(int32 i=0; i<count; i++){
+        if(data[CACHE_HEADER_LEN+i]<1 || data[CACHE_HEADER_LEN+i]>180){
+            return false;
+        }
+    }
+
+    FMemory::Memcpy(OutPositions, data.GetData()+CACHE_HEADER_LEN, count);
+    OutCount=count;
+    return true;
+}
+
+void FRemoteMCUInfoCache::Save(const FString& MCU_Name, const uint8* Positions, uint8 Count){
+
+    if(MCU_Name.IsEmpty() || Count==0 || Count>MAX_SERVOS){
+        return;
+    }
+    TArray<uint8> data;
+    data.SetNumUninitialized(CACHE_HEADER_LEN+Count);
+    FMemory::Memcpy(data.GetData(), &CACHE_MAGIC, 4);
+    data[4]=CACHE_VERSION;
+    data[5]=Count;
+    FMemory::Memcpy(data.GetData()+CACHE_HEADER_LEN, Positions, Count);
+
+    _Write(_Path(MCU_Name, TEXT(".bin")), MoveTemp(data));
+}
+
+bool FRemoteMCUInfoCache::LoadLimits(const FString& MCU_Name, uint8 (&OutMin)[MAX_SERVOS], uint8 (&OutMax)[MAX_SERVOS], uint8& OutCount){
+
+    TArray<uint8> data;
+    if(MCU_Name.IsEmpty() || !FFileHelper::LoadFileToArray(data, *_Path(MCU_Name, TEXT(".limits.bin")), FILEREAD_Silent)){
+        return false;
+    }
+
+    uint32 magic=0;
+    if(data.Num()>=CACHE_HEADER_LEN){
+        FMemory::Memcpy(&magic, data.GetData(), 4);
+    }
+    const uint8 count=data.Num()>=CACHE_HEADER_LEN ? data[5] : 0;
+    if(magic!=LIMITS_MAGIC || data[4]!=CACHE_VERSION || count==0 || count>MAX_SERVOS || data.Num()!=CACHE_HEADER_LEN+2*count){
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("Ignoring the invalid limits cache of %s"), *MCU_Name);
+        return false;
+    }
+    const uint8* mins=data.GetData()+CACHE_HEADER_LEN;
+    const uint8* maxs=mins+count;
+    for(int32 i=0; i<count; i++){
+        if(mins[i]<1 || maxs[i]>180 || mins[i]>maxs[i]){
+            return false;
+        }
+    }
+
+    FMemory::Memcpy(OutMin, mins, count);
+    FMemory::Memcpy(OutMax, maxs, count);
+    OutCount=count;
+    return true;
+}
+
+void FRemoteMCUInfoCache::SaveLimits(const FString& MCU_Name, const uint8* MinPositions, const uint8* MaxPositions, uint8 Count){
+
+    if(MCU_Name.IsEmpty() || Count==0 || Count>MAX_SERVOS){
+        return;
+    }
+    TArray<uint8> data;
+    data.SetNumUninitialized(CACHE_HEADER_LEN+2*Count);
+    FMemory::Memcpy(data.GetData(), &LIMITS_MAGIC, 4);
+    data[4]=CACHE_VERSION;
+    data[5]=Count;
+    FMemory::Memcpy(data.GetData()+CACHE_HEADER_LEN, MinPositions, Count);
+    FMemory::Memcpy(data.GetData()+CACHE_HEADER_LEN+Count, MaxPositions, Count);
+
+    _Write(_Path(MCU_Name, TEXT(".limits.bin")), MoveTemp(data));
+}
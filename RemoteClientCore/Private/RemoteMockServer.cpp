@@ -0,0 +1,696 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteMockServer.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "RemoteClientCore.h"
+#include "RemoteClientSharedMemory.h"
+#include "CLIErrorCode.h"
+#include "HAL/RunnableThread.h"
+#include "SocketSubsystem.h"
+#include "Sockets.h"
+#include "Common/TcpSocketBuilder.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+
+constexpr int32 MAX_CLIENT_FRAME = 1024;
+constexpr double MAX_WAIT_S = 0.001;    /* Longest sleep on the client socket, bounds the MCU ACK lateness */
+
+static bool _TypeIs(const uint8* frame, const char* type){
+    return FMemory::Memcmp(frame+3, type, 4)==0;
+}
+
+FRemoteMockServer::FRemoteMockServer(const FRemoteMockServerSettings& InSettings)
+    : settings(InSettings)
+    , random(1234)
+{
+    settings.ServoCount=FMath::Clamp<uint8>(settings.ServoCount, 1, MAX_SERVOS);
+    FMemory::Memset(positions, 91, MAX_SERVOS); /* 90 degrees, +1 wire offset */
+}
+
+FRemoteMockServer::~FRemoteMockServer(){
+    if(thread){
+        thread->Kill(true);
+        delete thread;
+        thread = nullptr;
+    }
+    if(listenSck){
+        listenSck->Close();
+        ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(listenSck);
+        listenSck = nullptr;
+    }
+    shmListener.Reset();
+}
+
+void FRemoteMockServer::ParseSettings(const TCHAR* Args, FRemoteMockServerSettings& InOut){
+    int32 servos=InOut.ServoCount;
+    int32 limitMin=InOut.LimitMin;
+    int32 limitMax=InOut.LimitMax;
+    FParse::Value(Args, TEXT("Port="), InOut.Port);
+    FParse::Value(Args, TEXT("Servos="), servos);
+    FParse::Value(Args, TEXT("Latency="), InOut.McuLatencyMs);
+    FParse::Value(Args, TEXT("Jitter="), InOut.McuJitterMs);
+    FParse::Value(Args, TEXT("Nack="), InOut.NackPercent);
+    FParse::Value(Args, TEXT("Split="), InOut.SegmentBytes);
+    FParse::Bool(Args, TEXT("Binary="), InOut.bAllowBinary);
+    FParse::Bool(Args, TEXT("Shm="), InOut.bSharedMemory);
+    FParse::Value(Args, TEXT("LimitMin="), limitMin);
+    FParse::Value(Args, TEXT("LimitMax="), limitMax);
+    InOut.ServoCount=(uint8)FMath::Clamp(servos, 1, MAX_SERVOS);
+    InOut.LimitMin=(uint8)FMath::Clamp(limitMin, 1, 180);
+    InOut.LimitMax=(uint8)FMath::Clamp(limitMax, (int32)InOut.LimitMin, 180);
+}
+
+bool FRemoteMockServer::Start(){
+    if(settings.bSharedMemory){
+        shmListener=MakeUnique<FSharedMemoryListener>();
+        if(!shmListener->Listen(settings.Port)){
+            shmListener.Reset();
+            return false;
+        }
+        thread = FRunnableThread::Create(this, TEXT("RemoteMockServer"), 0, TPri_AboveNormal);
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Mock server listening on shared memory channel %d (%d servos, MCU %.1f+-%.1f ms, %.1f%% NACK)"),
+            settings.Port, settings.ServoCount, settings.McuLatencyMs, settings.McuJitterMs, settings.NackPercent);
+        return true;
+    }
+    listenSck = FTcpSocketBuilder(TEXT("Mock server socket"))
+        .AsReusable()
+        .AsNonBlocking()
+        .BoundToPort(settings.Port)
+        .Listening(1)
+        .Build();
+    if(!listenSck){
+        UE_LOG(LogRemoteClientSystem, Error, TEXT("Mock server could not listen on port %d"), settings.Port);
+        return false;
+    }
+    thread = FRunnableThread::Create(this, TEXT("RemoteMockServer"), 0, TPri_AboveNormal);
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Mock server listening on port %d (%d servos, MCU %.1f+-%.1f ms, %.1f%% NACK, %d byte segments)"),
+        settings.Port, settings.ServoCount, settings.McuLatencyMs, settings.McuJitterMs, settings.NackPercent, settings.SegmentBytes);
+    return true;
+}
+
+void FRemoteMockServer::Stop(){
+    stopping=true;
+}
+
+uint32 FRemoteMockServer::Run(){
+
+    while(!stopping.load()){
+
+        if(!client){
+            _Accept();
+            continue;
+        }
+
+        const double now=FPlatformTime::Seconds();
+        _CompleteDueOrders(now);
+        if(telemetryPeriod>0 && now>=nextTelemetry){
+            nextTelemetry = now-nextTelemetry>telemetryPeriod ? now+telemetryPeriod : nextTelemetry+telemetryPeriod;
+            _SendServoFrame(FRemoteClientProtocol::BIN_TLMD, "TLMD");
+        }
+        if(!_FlushClient()){
+            _CloseClient();
+            continue;
+        }
+
+        double wait=MAX_WAIT_S;
+        if(mcuOrders.Num()>0){
+            wait=FMath::Clamp(mcuOrders[0].due-now, 0.0, MAX_WAIT_S);
+        }
+        if(telemetryPeriod>0){
+            wait=FMath::Clamp(nextTelemetry-now, 0.0, wait);
+        }
+        if(client->WaitForRead(FTimespan::FromSeconds(wait)) && !_ReadClient()){
+            _CloseClient();
+        }
+    }
+
+    _CloseClient();
+    return 0;
+}
+
+void FRemoteMockServer::_Accept(){
+
+    if(shmListener){
+        client=shmListener->Accept(FTimespan::FromMilliseconds(10));
+    }else{
+        bool bPending=false;
+        if(!listenSck->WaitForPendingConnection(bPending, FTimespan::FromMilliseconds(10)) || !bPending){
+            return;
+        }
+        if(FSocket* accepted=listenSck->Accept(TEXT("Mock client socket"))){
+            client=MakeUnique<FTcpTransport>(accepted);
+        }
+    }
+    if(!client){
+        return;
+    }
+
+    /* New session, the MCU keeps its positions */
+    protocol=EWireProtocol::Text;
+    bMcuSelected=false;
+    bRealTime=false;
+    mcuFreeAt=0;
+    telemetryPeriod=0;
+    mcuOrders.Reset();
+    inBuffer.Reset();
+    outBuffer.Reset();
+    UE_LOG(LogRemoteClientSystem, Display, TEXT("Mock server: client connected"));
+}
+
+void FRemoteMockServer::_CloseClient(){
+    if(client){
+        client.Reset();
+        UE_LOG(LogRemoteClientSystem, Display, TEXT("Mock server: client disconnected"));
+    }
+}
+
+/** Returns false once the client is gone */
+bool FRemoteMockServer::_ReadClient(){
+
+    uint8 chunk[4096];
+    while(true){
+        int32 byRead=0;
+        if(!client->Recv(chunk, sizeof(chunk), byRead)){
+            return false;
+        }
+        if(byRead<=0){
+            break;
+        }
+        inBuffer.Append(chunk, byRead);
+    }
+
+    int32 offset=0;
+    while(offset<inBuffer.Num()){
+        /* PROT switches the framing in between two frames of the same read */
+        const bool bBinary=protocol==EWireProtocol::Binary;
+        const int32 len=bBinary ? _NextBinaryFrame(offset) : _NextTextFrame(offset);
+        if(len==0){
+            break;
+        }
+        if(len<0){
+            offset++; /* Garbage */
+            continue;
+        }
+        if(bBinary){
+            _HandleBinary(inBuffer.GetData()+offset, len);
+        }else{
+            _HandleText(inBuffer.GetData()+offset, len);
+        }
+        offset+=len;
+    }
+    inBuffer.RemoveAt(0, offset, false);
+    return true;
+}
+
+/** Length of the text frame at offset, 0 if incomplete, -1 if there is no frame header there */
+int32 FRemoteMockServer::_NextTextFrame(int32 offset) const{
+
+    const uint8* f=inBuffer.GetData()+offset;
+    const int32 available=inBuffer.Num()-offset;
+    if(available<3){
+        return 0;
+    }
+    if(f[0]!='!' || f[1]!='s' || f[2]!='-'){
+        return -1;
+    }
+    if(available<10){
+        return 0;
+    }
+
+    /* Movement data may contain the tail sequence, their length comes from the servo count */
+    if(_TypeIs(f, "SRVP")){
+        return 10+4*f[8]+2<=available ? 10+4*f[8]+2 : 0;
+    }
+    if(_TypeIs(f, "SRVQ") || _TypeIs(f, "SRVU")){
+        return 12+4*f[8]+2<=available ? 12+4*f[8]+2 : 0;
+    }
+    if(_TypeIs(f, "RTSP")){
+        return 13+4*f[8]+2<=available ? 13+4*f[8]+2 : 0;
+    }
+    if(_TypeIs(f, "PROT") || _TypeIs(f, "RTMD")){
+        return available>=12 ? 12 : 0;
+    }
+    if(_TypeIs(f, "TLMS")){
+        return available>=13 ? 13 : 0;
+    }
+
+    for(int32 end=6; end<=FMath::Min(available, MAX_CLIENT_FRAME); end++){
+        if(f[end-3]=='-' && f[end-2]=='e' && f[end-1]=='!'){
+            return end;
+        }
+    }
+    return available>=MAX_CLIENT_FRAME ? -1 : 0;
+}
+
+int32 FRemoteMockServer::_NextBinaryFrame(int32 offset) const{
+
+    const uint8* f=inBuffer.GetData()+offset;
+    const int32 available=inBuffer.Num()-offset;
+    if(available<2){
+        return 0;
+    }
+    if(f[0]!=FRemoteClientProtocol::BINARY_SYNC || f[1]==0){
+        return -1;
+    }
+    return available>=2+f[1] ? 2+f[1] : 0;
+}
+
+void FRemoteMockServer::_HandleText(const uint8* frame, int32 len){
+
+    if(_TypeIs(frame, "Clie")){
+        return; /* Log-in, not answered */
+    }
+    if(_TypeIs(frame, "PROT")){
+        if(frame[8]==(uint8)EWireProtocol::Binary && settings.bAllowBinary){
+            _SendAck(0, FRemoteClientProtocol::STAGE_SERVER, frame[8]);
+            protocol=EWireProtocol::Binary;
+        }else if(frame[8]==(uint8)EWireProtocol::SequencedText){
+            /* SRVQ ACKs always echo the sequence, nothing changes */
+            _SendAck(0, FRemoteClientProtocol::STAGE_SERVER, frame[8]);
+        }else{
+            _SendNack(0, (uint8)ECLIErrorCode::NACK_InvalidParameter);
+        }
+        return;
+    }
+    if(_TypeIs(frame, "sMCU")){
+        bMcuSelected=len>11;
+        if(bMcuSelected){
+            _SendAck(0, FRemoteClientProtocol::STAGE_SERVER, 0);
+        }else{
+            _SendNack(0, (uint8)ECLIErrorCode::NACK_MCUOffline);
+        }
+        return;
+    }
+    if(_TypeIs(frame, "iMCU")){
+        _SendInfo();
+        return;
+    }
+    if(_TypeIs(frame, "lMCU")){
+        _SendLimits();
+        return;
+    }
+    if(_TypeIs(frame, "RTMD")){
+        bRealTime=frame[8]!=0;
+        _SendAck(0, FRemoteClientProtocol::STAGE_SERVER, 0);
+        return;
+    }
+    if(_TypeIs(frame, "TLMS")){
+        _SubscribeTelemetry((uint16)(frame[8]|(frame[9]<<8)));
+        return;
+    }
+
+    const bool bSequenced=_TypeIs(frame, "SRVQ");
+    const bool bSetpoint=_TypeIs(frame, "RTSP");
+    const bool bPriority=_TypeIs(frame, "SRVU");
+    if(!bSequenced && !bSetpoint && !bPriority && !_TypeIs(frame, "SRVP")){
+        _SendNack(0, (uint8)ECLIErrorCode::NACK_InvalidQuery);
+        return;
+    }
+
+    const int32 dataStart=bSetpoint ? 13 : (bSequenced || bPriority ? 12 : 10);
+    const uint16 seq=bSetpoint ? (uint16)(frame[10]|(frame[11]<<8)) : (bSequenced ? frame[10] : 0);
+    uint8 targets[MAX_SERVOS];
+    uint32 mask=0;
+    for(int32 i=0; i<frame[8]; i++){
+        const uint8* d=frame+dataStart+4*i;  /* id+1 ':' pos '-' */
+        const int32 id=d[0]-1;
+        if(id<0 || id>=settings.ServoCount || d[2]<settings.LimitMin || d[2]>settings.LimitMax){
+            if(bPriority){
+                _SendPriorityAck((uint8)ECLIErrorCode::NACK_InvalidParameter);
+            }else if(!bSetpoint){
+                _SendNack(seq, (uint8)ECLIErrorCode::NACK_InvalidParameter);
+            }
+            return;
+        }
+        targets[id]=d[2];
+        mask|=1u<<id;
+    }
+
+    if(bSetpoint){
+        if(bRealTime){
+            for(uint32 bits=mask; bits; bits&=bits-1){
+                positions[FMath::CountTrailingZeros(bits)]=targets[FMath::CountTrailingZeros(bits)];
+            }
+        }
+        return;
+    }
+    if(bPriority){
+        _HandlePriority(frame[10], mask, targets);
+        return;
+    }
+    _HandleMovement(seq, bSequenced, mask, targets);
+}
+
+void FRemoteMockServer::_HandleBinary(const uint8* frame, int32 len){
+
+    const uint8* p=frame+FRemoteClientProtocol::BINARY_HEADER_LEN;
+    const int32 payloadLen=len-FRemoteClientProtocol::BINARY_HEADER_LEN;
+
+    switch(frame[2]){
+        case FRemoteClientProtocol::BIN_sMCU:
+            bMcuSelected=payloadLen>0;
+            if(bMcuSelected){
+                _SendAck(0, FRemoteClientProtocol::STAGE_SERVER, 0);
+            }else{
+                _SendNack(0, (uint8)ECLIErrorCode::NACK_MCUOffline);
+            }
+            return;
+
+        case FRemoteClientProtocol::BIN_iMCU_QUERY:
+            _SendInfo();
+            return;
+
+        case FRemoteClientProtocol::BIN_lMCU_QUERY:
+            _SendLimits();
+            return;
+
+        case FRemoteClientProtocol::BIN_RTMD:
+            bRealTime=payloadLen>0 && p[0]!=0;
+            _SendAck(0, FRemoteClientProtocol::STAGE_SERVER, 0);
+            return;
+
+        case FRemoteClientProtocol::BIN_TLMS:
+            if(payloadLen!=2){
+                _SendNack(0, (uint8)ECLIErrorCode::NACK_InvalidParameter);
+                return;
+            }
+            _SubscribeTelemetry((uint16)(p[0]|(p[1]<<8)));
+            return;
+
+        case FRemoteClientProtocol::BIN_SRVP:
+        case FRemoteClientProtocol::BIN_RTSP:
+        {
+            if(payloadLen<6){
+                _SendNack(0, (uint8)ECLIErrorCode::NACK_InvalidQuery);
+                return;
+            }
+            const uint16 seq=(uint16)(p[0]|(p[1]<<8));
+            const uint32 mask=p[2]|(p[3]<<8)|(p[4]<<16)|((uint32)p[5]<<24);
+            const bool bSetpoint=frame[2]==FRemoteClientProtocol::BIN_RTSP;
+            if(payloadLen!=6+(int32)FMath::CountBits(mask) || (mask>>settings.ServoCount)!=0){
+                if(!bSetpoint){
+                    _SendNack(seq, (uint8)ECLIErrorCode::NACK_InvalidParameter);
+                }
+                return;
+            }
+            uint8 targets[MAX_SERVOS];
+            const uint8* pos=p+6;
+            for(uint32 bits=mask; bits; bits&=bits-1){
+                targets[FMath::CountTrailingZeros(bits)]=*pos++;
+            }
+            if(!_WithinLimits(mask, targets)){
+                if(!bSetpoint){
+                    _SendNack(seq, (uint8)ECLIErrorCode::NACK_InvalidParameter);
+                }
+                return;
+            }
+            if(bSetpoint){
+                if(bRealTime){
+                    for(uint32 bits=mask; bits; bits&=bits-1){
+                        positions[FMath::CountTrailingZeros(bits)]=targets[FMath::CountTrailingZeros(bits)];
+                    }
+                }
+                return;
+            }
+            _HandleMovement(seq, true, mask, targets);
+            return;
+        }
+
+        case FRemoteClientProtocol::BIN_SRVU:
+        {
+            const uint32 mask=payloadLen>=5 ? p[1]|(p[2]<<8)|(p[3]<<16)|((uint32)p[4]<<24) : 0;
+            if(payloadLen<5 || payloadLen!=5+(int32)FMath::CountBits(mask) || (mask>>settings.ServoCount)!=0){
+                _SendPriorityAck((uint8)ECLIErrorCode::NACK_InvalidParameter);
+                return;
+            }
+            uint8 targets[MAX_SERVOS];
+            const uint8* pos=p+5;
+            for(uint32 bits=mask; bits; bits&=bits-1){
+                targets[FMath::CountTrailingZeros(bits)]=*pos++;
+            }
+            if(!_WithinLimits(mask, targets)){
+                _SendPriorityAck((uint8)ECLIErrorCode::NACK_InvalidParameter);
+                return;
+            }
+            _HandlePriority(p[0], mask, targets);
+            return;
+        }
+
+        default:
+            _SendNack(0, (uint8)ECLIErrorCode::NACK_InvalidQuery);
+            return;
+    }
+}
+
+bool FRemoteMockServer::_WithinLimits(uint32 mask, const uint8 (&targets)[MAX_SERVOS]) const{
+    for(uint32 bits=mask; bits; bits&=bits-1){
+        const uint8 pos=targets[FMath::CountTrailingZeros(bits)];
+        if(pos<settings.LimitMin || pos>settings.LimitMax){
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Server ACK right away, MCU ACK once the simulated MCU is done with every order before this one and with this one */
+void FRemoteMockServer::_HandleMovement(uint16 seq, bool bSequenced, uint32 mask, const uint8 (&targets)[MAX_SERVOS]){
+
+    if(!bMcuSelected){
+        _SendNack(seq, (uint8)ECLIErrorCode::NACK_NoActiveMCU);
+        return;
+    }
+    if(bRealTime){
+        _SendNack(seq, (uint8)ECLIErrorCode::NACK_OnRTMode);
+        return;
+    }
+    if(settings.NackPercent>0.f && random.FRand()*100.f<settings.NackPercent){
+        _SendNack(seq, (uint8)ECLIErrorCode::NACK_ErrorContactingMCU);
+        return;
+    }
+
+    _SendAck(seq, FRemoteClientProtocol::STAGE_SERVER, bSequenced ? (uint8)seq : 0);
+
+    const double now=FPlatformTime::Seconds();
+    const double start=FMath::Max(now, mcuFreeAt);
+    const double jitter=settings.McuJitterMs*(2.f*random.FRand()-1.f);
+
+    FMcuOrder order;
+    order.due=start+FMath::Max(0.0, settings.McuLatencyMs+jitter)/1000.0;
+    order.seq=seq;
+    order.bSequenced=bSequenced;
+    order.bPriority=false;
+    order.mask=mask;
+    FMemory::Memcpy(order.positions, targets, MAX_SERVOS);
+    mcuOrders.Add(order);
+    mcuFreeAt=order.due;
+}
+
+/**
+ * The MCU interrupts what it is doing & applies the priority targets next (behind earlier priority ones), without jitter.
+ * The queued orders resume after it, unless the client cancelled them: those are dropped and never answered.
+ */
+void FRemoteMockServer::_HandlePriority(uint8 flags, uint32 mask, const uint8 (&targets)[MAX_SERVOS]){
+
+    if(!bMcuSelected){
+        _SendPriorityAck((uint8)ECLIErrorCode::NACK_NoActiveMCU);
+        return;
+    }
+    if(bRealTime){
+        _SendPriorityAck((uint8)ECLIErrorCode::NACK_OnRTMode);
+        return;
+    }
+
+    int32 at=0;
+    while(at<mcuOrders.Num() && mcuOrders[at].bPriority){
+        at++;
+    }
+    if(flags&FRemoteClientProtocol::PRIORITY_CANCEL_QUEUED){
+        mcuOrders.SetNum(at, false);
+    }
+
+    const double now=FPlatformTime::Seconds();
+    FMcuOrder order;
+    order.due=FMath::Max(now+settings.McuLatencyMs/1000.0, at>0 ? mcuOrders[at-1].due : 0.0);
+    order.seq=0;
+    order.bSequenced=false;
+    order.bPriority=true;
+    order.mask=mask;
+    FMemory::Memcpy(order.positions, targets, MAX_SERVOS);
+    mcuOrders.Insert(order, at);
+
+    /* Due times stay in completion order */
+    for(int32 i=at+1; i<mcuOrders.Num(); i++){
+        mcuOrders[i].due=FMath::Max(mcuOrders[i].due, order.due);
+    }
+    mcuFreeAt=mcuOrders.Last().due;
+}
+
+void FRemoteMockServer::_CompleteDueOrders(double now){
+    int32 done=0;
+    while(done<mcuOrders.Num() && mcuOrders[done].due<=now){
+        const FMcuOrder& order=mcuOrders[done];
+        for(uint32 bits=order.mask; bits; bits&=bits-1){
+            const uint32 i=FMath::CountTrailingZeros(bits);
+            positions[i]=order.positions[i];
+        }
+        if(order.bPriority){
+            _SendPriorityAck(0);
+        }else{
+            _SendAck(order.seq, FRemoteClientProtocol::STAGE_MCU, order.bSequenced ? (uint8)order.seq : 0);
+        }
+        done++;
+    }
+    mcuOrders.RemoveAt(0, done, false);
+}
+
+/** Sends the queued replies, split in SegmentBytes chunks if set. Returns false once the client is gone */
+bool FRemoteMockServer::_FlushClient(){
+    while(outBuffer.Num()>0){
+        const int32 chunk=settings.SegmentBytes>0 ? FMath::Min(settings.SegmentBytes, outBuffer.Num()) : outBuffer.Num();
+        int32 bySent=0;
+        if(!client->Send(outBuffer.GetData(), chunk, bySent)){
+            return false;
+        }
+        if(bySent<=0){
+            return true;
+        }
+        outBuffer.RemoveAt(0, bySent, false);
+    }
+    return true;
+}
+
+void FRemoteMockServer::_SendAck(uint16 seq, uint8 stage, uint8 code){
+    if(protocol==EWireProtocol::Binary){
+        const uint8 frame[]={FRemoteClientProtocol::BINARY_SYNC, 4, FRemoteClientProtocol::BIN_ACK, (uint8)(seq&0xFF), (uint8)(seq>>8), stage};
+        outBuffer.Append(frame, sizeof(frame));
+        return;
+    }
+    const uint8 frame[]={'!','s','-','_','A','C','K','-',code,'-','e','!'};
+    outBuffer.Append(frame, sizeof(frame));
+}
+
+void FRemoteMockServer::_SendNack(uint16 seq, uint8 code){
+    if(protocol==EWireProtocol::Binary){
+        const uint8 frame[]={FRemoteClientProtocol::BINARY_SYNC, 4, FRemoteClientProtocol::BIN_NACK, (uint8)(seq&0xFF), (uint8)(seq>>8), code};
+        outBuffer.Append(frame, sizeof(frame));
+        return;
+    }
+    const uint8 frame[]={'!','s','-','N','A','C','K','-',code,'-','e','!'};
+    outBuffer.Append(frame, sizeof(frame));
+}
+
+void FRemoteMockServer::_SendPriorityAck(uint8 code){
+    if(protocol==EWireProtocol::Binary){
+        const uint8 frame[]={FRemoteClientProtocol::BINARY_SYNC, 2, FRemoteClientProtocol::BIN_UACK, code};
+        outBuffer.Append(frame, sizeof(frame));
+        return;
+    }
+    const uint8 frame[]={'!','s','-','U','A','C','K','-',code,'-','e','!'};
+    outBuffer.Append(frame, sizeof(frame));
+}
+
+void FRemoteMockServer::_SubscribeTelemetry(uint16 rateHz){
+    if(!bMcuSelected){
+        _SendNack(0, (uint8)ECLIErrorCode::NACK_NoActiveMCU);
+        return;
+    }
+    telemetryPeriod=rateHz>0 ? 1.0/rateHz : 0;
+    nextTelemetry=FPlatformTime::Seconds();
+    _SendAck(0, FRemoteClientProtocol::STAGE_SERVER, 0);
+}
+
+void FRemoteMockServer::_SendInfo(){
+    if(!bMcuSelected){
+        _SendNack(0, (uint8)ECLIErrorCode::NACK_NoActiveMCU);
+        return;
+    }
+    _SendServoFrame(FRemoteClientProtocol::BIN_iMCU, "iMCU");
+}
+
+/** Same limits for every servo, 3 bytes per servo */
+void FRemoteMockServer::_SendLimits(){
+    if(!bMcuSelected){
+        _SendNack(0, (uint8)ECLIErrorCode::NACK_NoActiveMCU);
+        return;
+    }
+    const uint8 count=settings.ServoCount;
+    const bool bBinary=protocol==EWireProtocol::Binary;
+    if(bBinary){
+        const uint8 header[]={FRemoteClientProtocol::BINARY_SYNC, (uint8)(2+3*count), FRemoteClientProtocol::BIN_lMCU, count};
+        outBuffer.Append(header, sizeof(header));
+    }else{
+        const uint8 header[]={'!','s','-','l','M','C','U','-',count,'-'};
+        outBuffer.Append(header, sizeof(header));
+    }
+    for(int32 i=0; i<count; i++){
+        outBuffer.Add(settings.LimitMin);
+        outBuffer.Add(settings.LimitMax);
+        outBuffer.Add(bBinary ? 0 : '-');
+    }
+    if(!bBinary){
+        outBuffer.Add('e');
+        outBuffer.Add('!');
+    }
+}
+
+/** Current positions, 2 bytes per servo (iMCU reply & TLMD telemetry) */
+void FRemoteMockServer::_SendServoFrame(uint8 binaryType, const char* textType){
+
+    const uint8 count=settings.ServoCount;
+
+    if(protocol==EWireProtocol::Binary){
+        const uint8 header[]={FRemoteClientProtocol::BINARY_SYNC, (uint8)(2+2*count), binaryType, count};
+        outBuffer.Append(header, sizeof(header));
+        for(int32 i=0; i<count; i++){
+            outBuffer.Add(positions[i]);
+            outBuffer.Add(0);
+        }
+        return;
+    }
+
+    const uint8 header[]={'!','s','-',(uint8)textType[0],(uint8)textType[1],(uint8)textType[2],(uint8)textType[3],'-',count,'-'};
+    outBuffer.Append(header, sizeof(header));
+    for(int32 i=0; i<count; i++){
+        outBuffer.Add(positions[i]);
+        outBuffer.Add('-');
+    }
+    outBuffer.Add('e');
+    outBuffer.Add('!');
+}
+
+/* Console: RemoteClient.MockServer [Port=54817 Servos=16 Latency=5 Jitter=0 Nack=0 Split=0 Binary=1 Shm=0 LimitMin=1 LimitMax=180] | Stop */
+
+static TUniquePtr<FRemoteMockServer> GMockServer;
+
+static void _MockServerCommand(const TArray<FString>& Args){
+
+    static bool bHooked=false;
+    if(!bHooked){
+        /* Stopped before the socket subsystem goes away */
+        FCoreDelegates::OnPreExit.AddLambda([](){ GMockServer.Reset(); });
+        bHooked=true;
+    }
+
+    GMockServer.Reset();
+    if(Args.Num()>0 && Args[0]==TEXT("Stop")){
+        return;
+    }
+
+    const FString cmdLine=FString::Join(Args, TEXT(" "));
+
+    FRemoteMockServerSettings mockSettings;
+    FRemoteMockServer::ParseSettings(*cmdLine, mockSettings);
+    GMockServer=MakeUnique<FRemoteMockServer>(mockSettings);
+    if(!GMockServer->Start()){
+        GMockServer.Reset();
+    }
+}
+
+static FAutoConsoleCommand GMockServerCmd(
+    TEXT("RemoteClient.MockServer"),
+    TEXT("Starts (or restarts) a local mock robot server: Port= Servos= Latency=ms Jitter=ms Nack=% Split=bytes Binary=0/1 Shm=0/1 (shared memory channel of Port) LimitMin= LimitMax= (servo limits, 1-180). 'Stop' stops it"),
+    FConsoleCommandWithArgsDelegate::CreateStatic(&_MockServerCommand));
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ServerFrameDecoder.h"
+#include "RemoteClientProtocol.h"
+
+static_assert((FServerFrameDecoder::Capacity&(FServerFrameDecoder::Capacity-1))==0, "Decoder capacity must be a power of 2");
+static_assert(FServerFrameDecoder::MaxFrameLen<FServerFrameDecoder::Capacity, "A full frame must fit in the ring");
+
+constexpr uint32 ID_FRAME_CODE = 8;        /* !s-XXXX-c- */
+constexpr uint32 ID_FRAME_DATA_START = 10;
+constexpr uint32 FIXED_FRAME_LEN = 12;     /* !s-XXXX-c-e! */
+
+void FServerFrameDecoder::Reset(){
+    Head=0;
+    Tail=0;
+    binaryFraming=false;
+}
+
+uint8* FServerFrameDecoder::GetWriteBuffer(int32& OutSize){
+    if(Head==Tail){
+        /* Empty, rewind so the whole ring is contiguous */
+        Head=0;
+        Tail=0;
+    }
+    const uint32 pos=Tail&(Capacity-1);
+    const uint32 freeBytes=Capacity-(Tail-Head);
+    OutSize=(int32)FMath::Min(freeBytes, Capacity-pos);
+    return Ring+pos;
+}
+
+void FServerFrameDecoder::CommitWrite(int32 BytesWritten){
+    check(BytesWritten>=0 && (uint32)BytesWritten<=Capacity-(Tail-Head));
+    Tail+=BytesWritten;
+}
+
+bool FServerFrameDecoder::_IsHeaderAt(uint32 i) const{
+    return _At(i)=='!' && _At(i+1)=='s' && _At(i+2)=='-';
+}
+
+/** Shortest length the frame at Head can have, data bytes may contain the tail sequence so it is only searched after them */
+uint32 FServerFrameDecoder::_MinFrameLen() const{
+    const bool bInfo=_At(3)=='i' && _At(4)=='M' && _At(5)=='C' && _At(6)=='U';
+    const bool bTelemetry=_At(3)=='T' && _At(4)=='L' && _At(5)=='M' && _At(6)=='D';
+    if(bInfo || bTelemetry){
+        /* !s-iMCU-n- / !s-TLMD-n- followed by 2 bytes per servo, the last data byte may be the '-' of the tail */
+        return ID_FRAME_DATA_START+2*_At(ID_FRAME_CODE)+2;
+    }
+    if(_At(3)=='l' && _At(4)=='M' && _At(5)=='C' && _At(6)=='U'){
+        /* !s-lMCU-n- followed by min, max & '-' per servo */
+        return ID_FRAME_DATA_START+3*_At(ID_FRAME_CODE)+2;
+    }
+    return FIXED_FRAME_LEN;
+}
+
+EFrameDecodeResult FServerFrameDecoder::Next(TArrayView<const uint8>& OutFrame){
+
+    if(binaryFraming){
+        return _NextBinary(OutFrame);
+    }
+
+    const uint32 available=Tail-Head;
+    if(available<3){
+        return EFrameDecodeResult::Incomplete;
+    }
+
+    if(!_IsHeaderAt(0)){
+        /* Out of sync, skip to the next header candidate */
+        do{
+            Head++;
+        }while(Tail-Head>=3 && !_IsHeaderAt(0));
+        return EFrameDecodeResult::Corrupt;
+    }
+
+    if(available<=ID_FRAME_CODE){
+        return EFrameDecodeResult::Incomplete;
+    }
+
+    uint32 len=0;
+    const uint32 limit=FMath::Min(available, MaxFrameLen);
+    for(uint32 end=_MinFrameLen(); end<=limit; end++){
+        if(_At(end-3)=='-' && _At(end-2)=='e' && _At(end-1)=='!'){
+            len=end;
+            break;
+        }
+    }
+
+    if(len==0){
+        if(available>=MaxFrameLen){
+            /* No tail where there should be one, drop this header and resync */
+            Head+=3;
+            return EFrameDecodeResult::Corrupt;
+        }
+        return EFrameDecodeResult::Incomplete;
+    }
+
+    _Emit(len, OutFrame);
+    return EFrameDecodeResult::Frame;
+}
+
+/** [sync][len][type][payload], len counts the bytes after itself */
+EFrameDecodeResult FServerFrameDecoder::_NextBinary(TArrayView<const uint8>& OutFrame){
+
+    const uint32 available=Tail-Head;
+    if(available<2){
+        return EFrameDecodeResult::Incomplete;
+    }
+
+    if(_At(0)!=FRemoteClientProtocol::BINARY_SYNC || _At(1)==0){
+        /* Out of sync, skip to the next sync byte */
+        do{
+            Head++;
+        }while(Tail-Head>=1 && _At(0)!=FRemoteClientProtocol::BINARY_SYNC);
+        return EFrameDecodeResult::Corrupt;
+    }
+
+    const uint32 len=2+_At(1);
+    if(available<len){
+        return EFrameDecodeResult::Incomplete;
+    }
+
+    _Emit(len, OutFrame);
+    return EFrameDecodeResult::Frame;
+}
+
+void FServerFrameDecoder::_Emit(uint32 len, TArrayView<const uint8>& OutFrame){
+    const uint32 start=Head&(Capacity-1);
+    if(start+len<=Capacity){
+        OutFrame=TArrayView<const uint8>(Ring+start, len);
+    }else{
+        const uint32 firstPart=Capacity-start;
+        FMemory::Memcpy(Scratch, Ring+start, firstPart);
+        FMemory::Memcpy(Scratch+firstPart, Ring, len-firstPart);
+        OutFrame=TArrayView<const uint8>(Scratch, len);
+    }
+    Head+=len;
+}
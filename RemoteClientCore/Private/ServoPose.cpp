@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ServoPose.h"
+#include "ServoLanes.h"
+#include "Math/VectorRegister.h"
+
+static_assert(MAX_SERVOS%4==0, "Whole vectors of servos");
+
+FServoPoseConverter::FServoPoseConverter(){
+    for(int32 i=0; i<MAX_SERVOS; i++){
+        SetCalibration(i, FServoCalibration());
+    }
+    FMemory::Memzero(last);
+}
+
+void FServoPoseConverter::SetCalibration(int32 ServoID, const FServoCalibration& Calibration){
+    check(ServoID>=0 && ServoID<MAX_SERVOS);
+    FServoCalibration& c=calibrations[ServoID];
+    c=Calibration;
+    c.maxPosition=FMath::Min<uint8>(c.maxPosition, 179);
+    c.minPosition=FMath::Min(c.minPosition, c.maxPosition);
+
+    /* +1 for the wire offset, +0.5 so the truncation of the clamped value rounds it */
+    gain[ServoID]=c.bInvert ? -c.scale : c.scale;
+    bias[ServoID]=c.offset+1.5f;
+    lower[ServoID]=c.minPosition+1.5f;
+    upper[ServoID]=c.maxPosition+1.5f;
+    lastMask&=~(1u<<ServoID);
+}
+
+uint32 FServoPoseConverter::Convert(const float (&AnglesDeg)[MAX_SERVOS], uint32 Mask, uint8 (&OutWire)[MAX_SERVOS]){
+
+    /* Every lane is converted, masking only applies to the result */
+    alignas(16) int32 quantized[MAX_SERVOS];
+    for(int32 i=0; i<MAX_SERVOS; i+=4){
+        VectorRegister4Float v=VectorMultiplyAdd(VectorLoad(AnglesDeg+i), VectorLoadAligned(gain+i), VectorLoadAligned(bias+i));
+        v=VectorMin(VectorMax(v, VectorLoadAligned(lower+i)), VectorLoadAligned(upper+i));
+        VectorIntStoreAligned(VectorFloatToInt(v), quantized+i);
+    }
+    for(int32 i=0; i<MAX_SERVOS; i++){
+        /* Clamped, so within 1-180 */
+        OutWire[i]=(uint8)quantized[i];
+    }
+
+    const uint32 changed=(ServoLanes::Differ(OutWire, last)|~lastMask)&Mask;
+    for(uint32 m=changed; m!=0; m&=m-1){
+        const int32 i=FMath::CountTrailingZeros(m);
+        last[i]=OutWire[i];
+    }
+    lastMask|=Mask;
+    return changed;
+}
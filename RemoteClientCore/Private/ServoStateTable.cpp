@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ServoStateTable.h"
+#include "ServoLanes.h"
+
+FServoStateTable::FServoStateTable(){
+    servoCount.store(0, std::memory_order_relaxed);
+    dirtyMask.store(0, std::memory_order_relaxed);
+    pendingSince.store(0, std::memory_order_relaxed);
+    sequence.store(2, std::memory_order_relaxed);
+    for(auto i=0; i<MAX_SERVOS; i++){
+        pendingSlots[i].store(0, std::memory_order_relaxed);
+        currentSlots[i].store(0, std::memory_order_relaxed);
+    }
+    for(auto w=0; w<ServoLanes::WORDS; w++){
+        limitMin[w].store(ServoLanes::ONES*1, std::memory_order_relaxed);
+        limitMax[w].store(ServoLanes::ONES*180, std::memory_order_relaxed);
+    }
+    ResetMCULimits();
+}
+
+uint32 FServoStateTable::SetPending(const uint8* positions, uint32 mask){
+    for(uint32 bits=mask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        pendingSlots[i].store(positions[i], std::memory_order_relaxed);
+    }
+    /* Only the first write after a take is stamped. A take racing with it may leave later bits unstamped, they are then just not timed */
+    uint64 unset=0;
+    pendingSince.compare_exchange_strong(unset, FPlatformTime::Cycles64(), std::memory_order_relaxed);
+
+    /* Release: a sender that sees the bit also sees the slot */
+    return dirtyMask.fetch_or(mask, std::memory_order_release)&mask;
+}
+
+uint32 FServoStateTable::TakePending(uint8 (&OutPositions)[MAX_SERVOS], uint64& OutSinceCycles){
+    /* A slot rewritten after the exchange keeps its bit set, at worst the same target is sent twice */
+    const uint32 mask=dirtyMask.exchange(0, std::memory_order_acquire);
+    OutSinceCycles=pendingSince.exchange(0, std::memory_order_relaxed);
+    for(uint32 bits=mask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        OutPositions[i]=pendingSlots[i].load(std::memory_order_relaxed);
+    }
+    return mask;
+}
+
+void FServoStateTable::_BeginWrite(){
+    /* Single writer, readers retry while the sequence is odd or has moved */
+    sequence.store(sequence.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void FServoStateTable::_EndWrite(){
+    sequence.store(sequence.load(std::memory_order_relaxed)+1, std::memory_order_release);
+}
+
+void FServoStateTable::CommitPositions(const uint8 (&positions)[MAX_SERVOS], uint32 mask){
+    if(mask==0){
+        return;
+    }
+    _BeginWrite();
+    for(uint32 bits=mask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        currentSlots[i].store(positions[i], std::memory_order_relaxed);
+    }
+    _EndWrite();
+}
+
+uint32 FServoStateTable::UpdatePositions(const uint8* positions, uint8 count){
+
+    /* Single writer, the current slots can be compared without the seqlock */
+    count=FMath::Min(count, servoCount.load(std::memory_order_relaxed));
+    uint32 moved=0;
+    for(auto i=0; i<count; i++){
+        if(currentSlots[i].load(std::memory_order_relaxed)!=positions[i]){
+            moved|=1u<<i;
+        }
+    }
+    if(moved==0){
+        return 0;
+    }
+    _BeginWrite();
+    for(uint32 bits=moved; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        currentSlots[i].store(positions[i], std::memory_order_relaxed);
+    }
+    _EndWrite();
+    return moved;
+}
+
+void FServoStateTable::Reset(const uint8* positions, uint8 count){
+    count=FMath::Min<uint8>(count, MAX_SERVOS);
+    dirtyMask.store(0, std::memory_order_relaxed);
+    pendingSince.store(0, std::memory_order_relaxed);
+    _BeginWrite();
+    for(auto i=0; i<MAX_SERVOS; i++){
+        currentSlots[i].store(i<count ? positions[i] : 0, std::memory_order_relaxed);
+    }
+    servoCount.store(count, std::memory_order_relaxed);
+    _EndWrite();
+}
+
+void FServoStateTable::SetLimits(const uint8 (&MinPositions)[MAX_SERVOS], const uint8 (&MaxPositions)[MAX_SERVOS]){
+    /* Word by word: a check racing with the update sees each group of 8 servos either old or new */
+    for(auto w=0; w<ServoLanes::WORDS; w++){
+        limitMin[w].store(ServoLanes::Load(MinPositions+8*w), std::memory_order_relaxed);
+        limitMax[w].store(ServoLanes::Load(MaxPositions+8*w), std::memory_order_relaxed);
+    }
+}
+
+void FServoStateTable::SetMCULimits(const uint8 (&MinPositions)[MAX_SERVOS], const uint8 (&MaxPositions)[MAX_SERVOS]){
+    for(auto w=0; w<ServoLanes::WORDS; w++){
+        mcuMin[w].store(ServoLanes::Load(MinPositions+8*w), std::memory_order_relaxed);
+        mcuMax[w].store(ServoLanes::Load(MaxPositions+8*w), std::memory_order_relaxed);
+    }
+    mcuLimitsSet.store(true, std::memory_order_relaxed);
+}
+
+void FServoStateTable::ResetMCULimits(){
+    for(auto w=0; w<ServoLanes::WORDS; w++){
+        mcuMin[w].store(ServoLanes::ONES*1, std::memory_order_relaxed);
+        mcuMax[w].store(ServoLanes::ONES*180, std::memory_order_relaxed);
+    }
+    mcuLimitsSet.store(false, std::memory_order_relaxed);
+}
+
+void FServoStateTable::_LoadLimits(uint64 (&OutMin)[MAX_SERVOS/8], uint64 (&OutMax)[MAX_SERVOS/8]) const{
+    for(auto w=0; w<ServoLanes::WORDS; w++){
+        OutMin[w]=ServoLanes::Max(limitMin[w].load(std::memory_order_relaxed), mcuMin[w].load(std::memory_order_relaxed));
+        OutMax[w]=ServoLanes::Min(limitMax[w].load(std::memory_order_relaxed), mcuMax[w].load(std::memory_order_relaxed));
+    }
+}
+
+uint32 FServoStateTable::FindOutOfLimits(const uint8 (&positions)[MAX_SERVOS], uint32 mask) const{
+    uint64 minWords[ServoLanes::WORDS];
+    uint64 maxWords[ServoLanes::WORDS];
+    _LoadLimits(minWords, maxWords);
+    return ServoLanes::OutOfRange(positions, minWords, maxWords)&mask;
+}
+
+uint32 FServoStateTable::FindOutOfRange(const uint8 (&positions)[MAX_SERVOS], uint32 mask){
+    static constexpr uint64 minWords[ServoLanes::WORDS]={ServoLanes::ONES*1, ServoLanes::ONES*1, ServoLanes::ONES*1, ServoLanes::ONES*1};
+    static constexpr uint64 maxWords[ServoLanes::WORDS]={ServoLanes::ONES*180, ServoLanes::ONES*180, ServoLanes::ONES*180, ServoLanes::ONES*180};
+    return ServoLanes::OutOfRange(positions, minWords, maxWords)&mask;
+}
+
+void FServoStateTable::ClampToLimits(const uint8 (&positions)[MAX_SERVOS], uint8 (&OutPositions)[MAX_SERVOS]) const{
+    uint64 minWords[ServoLanes::WORDS];
+    uint64 maxWords[ServoLanes::WORDS];
+    _LoadLimits(minWords, maxWords);
+    ServoLanes::Clamp(positions, minWords, maxWords, OutPositions);
+}
+
+void FServoStateTable::GetLimits(uint8 (&OutMin)[MAX_SERVOS], uint8 (&OutMax)[MAX_SERVOS]) const{
+    uint64 minWords[ServoLanes::WORDS];
+    uint64 maxWords[ServoLanes::WORDS];
+    _LoadLimits(minWords, maxWords);
+    for(auto w=0; w<ServoLanes::WORDS; w++){
+        ServoLanes::Store(OutMin+8*w, minWords[w]);
+        ServoLanes::Store(OutMax+8*w, maxWords[w]);
+    }
+}
+
+bool FServoStateTable::ReadSnapshot(FServoPositionSnapshot& InOutSnapshot) const{
+
+    while(true){
+        const uint64 seq=sequence.load(std::memory_order_acquire);
+        if(seq&1){
+            continue; /* Writer in progress, at most 32 stores away */
+        }
+        if((seq>>1)==InOutSnapshot.version){
+            return false;
+        }
+
+        const uint8 count=servoCount.load(std::memory_order_relaxed);
+        for(auto i=0; i<count; i++){
+            InOutSnapshot.positions[i]=currentSlots[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(sequence.load(std::memory_order_relaxed)==seq){
+            InOutSnapshot.servoCount=count;
+            InOutSnapshot.version=seq>>1;
+            return true;
+        }
+    }
+}
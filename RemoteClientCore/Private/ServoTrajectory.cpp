@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ServoTrajectory.h"
+#include "Algo/StableSort.h"
+
+void FTrajectoryScheduler::Clear(){
+    for(auto& track : tracks){
+        track.keys.Reset();
+        track.segment=0;
+    }
+    activeMask=0;
+}
+
+void FTrajectoryScheduler::Load(TArrayView<const FServoKeyframe> Keyframes, ETrajectoryInterpolation Interpolation, bool bAppend, double Now,
+    const uint8 (&StartPositions)[MAX_SERVOS]){
+
+    /* Appended batches start where the whole playing trajectory ends, so servos stay in step */
+    double origin=Now;
+    if(bAppend){
+        for(uint32 bits=activeMask; bits; bits&=bits-1){
+            origin=FMath::Max(origin, tracks[FMath::CountTrailingZeros(bits)].keys.Last().time);
+        }
+    }
+
+    uint32 batchMask=0;
+    for(const auto& key : Keyframes){
+        batchMask|=1u<<key.servoID;
+    }
+
+    for(uint32 bits=batchMask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        FTrack& track=tracks[i];
+        const bool bPlaying=(activeMask&(1u<<i))!=0;
+
+        if(!bAppend || !bPlaying){
+            const float start=bPlaying ? _Evaluate(track, Now) : (float)StartPositions[i];
+            track.keys.Reset();
+            track.segment=0;
+            track.keys.Add(FKey{Now, start});
+            track.lastSent=(uint8)FMath::RoundToInt(start);
+        }
+        track.interpolation=Interpolation;
+        if(track.keys.Last().time<origin){
+            /* Hold until the appended batch starts */
+            track.keys.Add(FKey{origin, track.keys.Last().position});
+        }
+
+        const int32 first=track.keys.Num();
+        for(const auto& key : Keyframes){
+            if(key.servoID==i){
+                track.keys.Add(FKey{origin+FMath::Max(key.time, 0.f), 1.f+key.servoPosition}); /* +1 wire offset */
+            }
+        }
+        /* Batches do not have to be sorted, only the new keys are */
+        Algo::StableSortBy(MakeArrayView(track.keys.GetData()+first, track.keys.Num()-first), &FKey::time);
+        activeMask|=1u<<i;
+    }
+}
+
+uint32 FTrajectoryScheduler::Sample(double Now, uint8 (&OutPositions)[MAX_SERVOS]){
+
+    uint32 changed=0;
+    for(uint32 bits=activeMask; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        FTrack& track=tracks[i];
+
+        const uint8 pos=(uint8)FMath::Clamp(FMath::RoundToInt(_Evaluate(track, Now)), 1, 180);
+        if(pos!=track.lastSent){
+            track.lastSent=pos;
+            OutPositions[i]=pos;
+            changed|=1u<<i;
+        }
+        if(Now>=track.keys.Last().time){
+            /* Last keyframe reached & emitted */
+            track.keys.Reset();
+            track.segment=0;
+            activeMask&=~(1u<<i);
+        }
+    }
+    return changed;
+}
+
+float FTrajectoryScheduler::_Evaluate(FTrack& track, double time){
+
+    const TArray<FKey>& k=track.keys;
+    const int32 last=k.Num()-1;
+    if(time<=k[0].time || last==0){
+        return k[0].position;
+    }
+    if(time>=k[last].time){
+        return k[last].position;
+    }
+
+    int32 s=FMath::Min(track.segment, last-1);
+    while(s<last-1 && time>=k[s+1].time){
+        s++;
+    }
+    track.segment=s;
+
+    const double h=k[s+1].time-k[s].time;
+    if(h<=0){
+        return k[s+1].position;
+    }
+    const float alpha=(float)((time-k[s].time)/h);
+
+    if(track.interpolation==ETrajectoryInterpolation::Linear){
+        return FMath::Lerp(k[s].position, k[s+1].position, alpha);
+    }
+
+    /* Non-uniform Catmull-Rom tangents, zero at both ends so the servo eases in & out */
+    auto tangent=[&k, last](int32 i)->float{
+        if(i<=0 || i>=last){
+            return 0.f;
+        }
+        const double span=k[i+1].time-k[i-1].time;
+        return span>0 ? (float)((k[i+1].position-k[i-1].position)/span) : 0.f;
+    };
+    return FMath::CubicInterp(k[s].position, tangent(s)*(float)h, k[s+1].position, tangent(s+1)*(float)h, alpha);
+}
@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "RemoteClientConnection.h"
+#include "RemoteMockServer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && !UE_BUILD_SHIPPING
+
+/* Against a local mock server: futures, NACKs & servo limits end to end. Ports are apart from the bench's (54899) */
+
+static bool _Connect(FAutomationTestBase& Test, FRemoteClientConnection& Conn, int32 Port, int32 Window, ERemoteClientLimitMode LimitMode){
+    FRemoteClientSettings settings;
+    settings.IpAdr=TEXT("127.0.0.1");
+    settings.Port=Port;
+    settings.mcuName=TEXT("Mock");
+    settings.MaxInFlightOrders=Window;
+    settings.bWarmStart=false;
+    settings.LimitMode=LimitMode;
+    TFuture<ECLIErrorCode> connected=Conn.Connect(settings);
+    if(!connected.WaitFor(FTimespan::FromSeconds(5.0)) || connected.Get()!=ECLIErrorCode::CLEAR){
+        Test.AddError(FString::Printf(TEXT("Mock server start up failed (%d)"), (int32)Conn.GetErr()));
+        return false;
+    }
+    return true;
+}
+
+static ECLIErrorCode _Wait(TFuture<ECLIErrorCode>& Future){
+    return Future.WaitFor(FTimespan::FromSeconds(5.0)) ? Future.Get() : ECLIErrorCode::GenericError;
+}
+
+static ECLIErrorCode _Wait(TFuture<ECLIErrorCode>&& Future){
+    return _Wait(Future);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRemoteClientConnectionMovementTest, "RemoteClient.Core.Connection.Movements", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRemoteClientConnectionMovementTest::RunTest(const FString& Parameters){
+
+    FRemoteMockServerSettings mock;
+    mock.Port=54931;
+    mock.McuLatencyMs=1.f;
+    mock.LimitMin=11;
+    mock.LimitMax=150;
+    FRemoteMockServer server(mock);
+    if(!server.Start()){
+        AddError(TEXT("Mock server could not start"));
+        return false;
+    }
+    FRemoteClientConnection conn;
+    if(!_Connect(*this, conn, mock.Port, 4, ERemoteClientLimitMode::Reject)){
+        return false;
+    }
+
+    /* Pipelined orders, every future completes */
+    TArray<TFuture<ECLIErrorCode>> futures;
+    for(int32 i=0; i<20; i++){
+        const FServoInfo movements[]={FServoInfo(0, 20+i), FServoInfo(3, 100-i)};
+        futures.Add(conn.SendMovementAsync(MakeArrayView(movements)));
+    }
+    for(auto& future : futures){
+        TestTrue(TEXT("Movement completed"), _Wait(future)==ECLIErrorCode::CLEAR);
+    }
+
+    /* Refused locally: the future is already done & the error is sticky until ClearErr */
+    const FServoInfo invalid[]={FServoInfo(31, 90)};
+    TFuture<ECLIErrorCode> refused=conn.SendMovementAsync(MakeArrayView(invalid));
+    TestTrue(TEXT("Refused right away"), refused.IsReady() && refused.Get()==ECLIErrorCode::INVALID_SERVO_ID);
+    TestTrue(TEXT("Sticky error"), conn.GetErr()==ECLIErrorCode::INVALID_SERVO_ID);
+
+    TestTrue(TEXT("Error cleared"), _Wait(conn.ClearErr())==ECLIErrorCode::CLEAR);
+    const FServoInfo valid[]={FServoInfo(1, 90)};
+    TFuture<ECLIErrorCode> accepted=conn.SendMovementAsync(MakeArrayView(valid));
+    TestTrue(TEXT("Accepted after ClearErr"), _Wait(accepted)==ECLIErrorCode::CLEAR);
+
+    /* Limits retrieved on start up (lMCU), user units 0-179 */
+    uint8 mins[MAX_SERVOS];
+    uint8 maxs[MAX_SERVOS];
+    conn.GetServoLimits(mins, maxs);
+    TestTrue(TEXT("MCU limits known"), conn.HasMCULimits());
+    TestTrue(TEXT("MCU limits"), mins[0]==10 && maxs[0]==149);
+
+    /* Refused locally, without a round trip: the future is already done */
+    const FServoInfo outside[]={FServoInfo(0, 160)};
+    TFuture<ECLIErrorCode> outOfLimits=conn.SendMovementAsync(MakeArrayView(outside));
+    TestTrue(TEXT("Out of limits refused"), outOfLimits.IsReady() && outOfLimits.Get()==ECLIErrorCode::INVALID_SERVO_POSITION);
+    TestTrue(TEXT("Sticky limit error"), conn.GetErr()==ECLIErrorCode::INVALID_SERVO_POSITION);
+    TFuture<ECLIErrorCode> priority=conn.SendPriorityMovement(MakeArrayView(outside), false);
+    TestTrue(TEXT("Priority refused"), priority.IsReady() && priority.Get()==ECLIErrorCode::INVALID_SERVO_POSITION);
+
+    TestTrue(TEXT("Error cleared"), _Wait(conn.ClearErr())==ECLIErrorCode::CLEAR);
+    const FServoInfo inside[]={FServoInfo(0, 149)};
+    TFuture<ECLIErrorCode> atLimit=conn.SendMovementAsync(MakeArrayView(inside));
+    TestTrue(TEXT("Upper limit accepted"), _Wait(atLimit)==ECLIErrorCode::CLEAR);
+
+    conn.Disconnect();
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRemoteClientConnectionClampTest, "RemoteClient.Core.Connection.Clamp", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRemoteClientConnectionClampTest::RunTest(const FString& Parameters){
+
+    FRemoteMockServerSettings mock;
+    mock.Port=54932;
+    mock.McuLatencyMs=1.f;
+    mock.LimitMax=150;
+    FRemoteMockServer server(mock);
+    if(!server.Start()){
+        AddError(TEXT("Mock server could not start"));
+        return false;
+    }
+    FRemoteClientConnection conn;
+    if(!_Connect(*this, conn, mock.Port, 1, ERemoteClientLimitMode::Clamp)){
+        return false;
+    }
+
+    const FServoInfo outside[]={FServoInfo(0, 179)};
+    TFuture<ECLIErrorCode> clamped=conn.SendMovementAsync(MakeArrayView(outside));
+    TestTrue(TEXT("Clamped movement completed"), _Wait(clamped)==ECLIErrorCode::CLEAR);
+
+    FServoPositionSnapshot snapshot;
+    conn.ReadServoPositions(snapshot);
+    TestEqual(TEXT("Servo stopped at its limit (wire)"), (int32)snapshot.positions[0], 150);
+
+    conn.Disconnect();
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRemoteClientConnectionNackTest, "RemoteClient.Core.Connection.Nack", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/* A NACK fails the movements it covers with its code, never reports them done */
+bool FRemoteClientConnectionNackTest::RunTest(const FString& Parameters){
+
+    FRemoteMockServerSettings mock;
+    mock.Port=54933;
+    mock.NackPercent=100.f;
+    FRemoteMockServer server(mock);
+    if(!server.Start()){
+        AddError(TEXT("Mock server could not start"));
+        return false;
+    }
+    FRemoteClientConnection conn;
+    if(!_Connect(*this, conn, mock.Port, 1, ERemoteClientLimitMode::Reject)){
+        return false;
+    }
+
+    const FServoInfo movements[]={FServoInfo(1, 90)};
+    TFuture<ECLIErrorCode> nacked=conn.SendMovementAsync(MakeArrayView(movements));
+    TestTrue(TEXT("Movement failed with the NACK code"), _Wait(nacked)==ECLIErrorCode::NACK_ErrorContactingMCU);
+
+    conn.Disconnect();
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS && !UE_BUILD_SHIPPING
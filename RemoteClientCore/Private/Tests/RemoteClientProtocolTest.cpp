@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "RemoteClientProtocol.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRemoteClientProtocolMovementTest, "RemoteClient.Core.Protocol.Movement", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/* Movement frames written in place read back to the same targets, in both protocols, sequenced or not */
+bool FRemoteClientProtocolMovementTest::RunTest(const FString& Parameters){
+
+    uint8 positions[MAX_SERVOS];
+    for(int32 i=0; i<MAX_SERVOS; i++){
+        positions[i]=(uint8)(1+(i*13)%180);
+    }
+    const uint32 masks[]={0x1u, 0x80000001u, 0x00FF00F0u, ~0u};
+
+    struct FCase { EWireProtocol protocol; bool bSequenced; };
+    const FCase cases[]={{EWireProtocol::Text, false}, {EWireProtocol::Text, true}, {EWireProtocol::Binary, true}};
+
+    TArray<uint8> out;
+    out.Reserve(FRemoteClientProtocol::MAX_MOVEMENT_FRAME_LEN);
+    for(const FCase& c : cases){
+        for(const uint32 mask : masks){
+            out.Reset();
+            FRemoteClientProtocol::AppendMovement(out, c.protocol, 0x1234, c.bSequenced, mask, positions);
+            TestTrue(TEXT("Frame within the worst case"), out.Num()<=FRemoteClientProtocol::MAX_MOVEMENT_FRAME_LEN);
+
+            uint32 readMask=0;
+            uint8 read[MAX_SERVOS]={};
+            if(!FRemoteClientProtocol::ParseMovement(c.protocol, out, readMask, read)){
+                AddError(FString::Printf(TEXT("Movement frame %08x (protocol %d) not read back"), mask, (int32)c.protocol));
+                continue;
+            }
+            TestTrue(TEXT("Mask read back"), readMask==mask);
+            for(uint32 bits=mask; bits; bits&=bits-1){
+                const uint32 i=FMath::CountTrailingZeros(bits);
+                TestEqual(TEXT("Position read back"), (int32)read[i], (int32)positions[i]);
+            }
+            if(c.protocol==EWireProtocol::Text && c.bSequenced){
+                TestEqual(TEXT("SRVQ tag of 0x1234"), (int32)out[10], (int32)'K');
+            }
+        }
+    }
+
+    /* Tags stay printable & off the delimiters, and never repeat within the text order window */
+    for(int32 seq=0; seq<FRemoteClientProtocol::TEXT_SEQ_TAGS; seq++){
+        const uint8 tag=FRemoteClientProtocol::TextSeqTag((uint16)seq);
+        TestTrue(TEXT("Tag off the delimiters"), FChar::IsAlnum(tag) && tag!='e');
+        for(int32 other=seq+1; other<seq+FRemoteClientProtocol::MAX_TEXT_ORDER_WINDOW; other++){
+            TestTrue(TEXT("Tags unique within the window"), FRemoteClientProtocol::TextSeqTag((uint16)other)!=tag);
+        }
+    }
+
+    /* Appended frames keep what was already in the buffer */
+    out.Reset();
+    FRemoteClientProtocol::AppendLimitsQuery(out, EWireProtocol::Text);
+    FRemoteClientProtocol::AppendInfoQuery(out, EWireProtocol::Text);
+    TestTrue(TEXT("Queries back to back"), out.Num()==20 && FMemory::Memcmp(out.GetData(), "!s-lMCU-e!!s-iMCU-e!", 20)==0);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRemoteClientProtocolReplyTest, "RemoteClient.Core.Protocol.Reply", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FRemoteClientProtocolReplyTest::RunTest(const FString& Parameters){
+
+    FServerReply reply;
+    const uint8 ack[]={'!','s','-','_','A','C','K','-',7,'-','e','!'};
+    TestTrue(TEXT("Text ACK"), FRemoteClientProtocol::ParseReply(EWireProtocol::Text, MakeArrayView(ack), reply) && reply.type==EServerReply::ACK && reply.code==7);
+
+    const uint8 info[]={'!','s','-','i','M','C','U','-',2,'-',90,'-',180,'-','e','!'};
+    reply=FServerReply();
+    TestTrue(TEXT("Text iMCU"), FRemoteClientProtocol::ParseReply(EWireProtocol::Text, MakeArrayView(info), reply) && reply.type==EServerReply::iMCU);
+    TestTrue(TEXT("iMCU servos"), reply.servoCount==2 && reply.servoData[0]==90 && reply.servoData[2]==180);
+
+    const uint8 limits[]={FRemoteClientProtocol::BINARY_SYNC, 2+3*2, FRemoteClientProtocol::BIN_lMCU, 2, 10,170,0, 1,180,0};
+    reply=FServerReply();
+    TestTrue(TEXT("Binary lMCU"), FRemoteClientProtocol::ParseReply(EWireProtocol::Binary, MakeArrayView(limits), reply) && reply.type==EServerReply::Limits);
+    TestTrue(TEXT("lMCU servos"), reply.servoCount==2 && reply.servoDataLen==6 && reply.servoData[0]==10 && reply.servoData[1]==170 && reply.servoData[4]==180);
+
+    const uint8 shortAck[]={'!','s','-','_','A','C','K','-','e','!'};
+    TestFalse(TEXT("Truncated ACK refused"), FRemoteClientProtocol::ParseReply(EWireProtocol::Text, MakeArrayView(shortAck), reply));
+    const uint8 badLen[]={FRemoteClientProtocol::BINARY_SYNC, 9, FRemoteClientProtocol::BIN_ACK, 1, 0, 1};
+    TestFalse(TEXT("Binary length mismatch refused"), FRemoteClientProtocol::ParseReply(EWireProtocol::Binary, MakeArrayView(badLen), reply));
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
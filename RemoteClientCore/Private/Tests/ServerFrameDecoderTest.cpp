@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "ServerFrameDecoder.h"
+#include "RemoteClientProtocol.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/* Bytes written the way the connection does: into the free region the decoder hands out */
+static void _Feed(FServerFrameDecoder& decoder, const uint8* data, int32 len){
+    while(len>0){
+        int32 freeBytes=0;
+        uint8* dst=decoder.GetWriteBuffer(freeBytes);
+        const int32 n=FMath::Min(freeBytes, len);
+        check(n>0);
+        FMemory::Memcpy(dst, data, n);
+        decoder.CommitWrite(n);
+        data+=n;
+        len-=n;
+    }
+}
+
+template<int32 N>
+static TArray<uint8> _Bytes(const char (&Text)[N]){ return TArray<uint8>((const uint8*)Text, N-1); }
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FServerFrameDecoderTextTest, "RemoteClient.Core.FrameDecoder.Text", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FServerFrameDecoderTextTest::RunTest(const FString& Parameters){
+
+    FServerFrameDecoder decoder;
+    TArrayView<const uint8> frame;
+
+    /* One byte at a time: incomplete until the tail is in */
+    const TArray<uint8> ack=_Bytes("!s-_ACK-0-e!");
+    for(int32 i=0; i<ack.Num()-1; i++){
+        _Feed(decoder, ack.GetData()+i, 1);
+        TestTrue(TEXT("Partial frame"), decoder.Next(frame)==EFrameDecodeResult::Incomplete);
+    }
+    _Feed(decoder, &ack.Last(), 1);
+    TestTrue(TEXT("Complete frame"), decoder.Next(frame)==EFrameDecodeResult::Frame);
+    TestTrue(TEXT("Frame bytes"), frame.Num()==ack.Num() && FMemory::Memcmp(frame.GetData(), ack.GetData(), ack.Num())==0);
+    TestEqual(TEXT("Nothing left"), decoder.Num(), 0);
+
+    /* Limits data containing the tail sequence: the frame only ends after 3 bytes per servo */
+    const uint8 limits[]={'!','s','-','l','M','C','U','-',2,'-', 1,180,'-', 'e','!','-', 'e','!'};
+    _Feed(decoder, limits, sizeof(limits));
+    TestTrue(TEXT("lMCU frame"), decoder.Next(frame)==EFrameDecodeResult::Frame);
+    TestEqual(TEXT("lMCU length"), frame.Num(), (int32)sizeof(limits));
+
+    /* Garbage ahead of a frame is skipped & reported once */
+    const TArray<uint8> noisy=_Bytes("xx!s-NACK-\xfc-e!");
+    _Feed(decoder, noisy.GetData(), noisy.Num());
+    TestTrue(TEXT("Garbage"), decoder.Next(frame)==EFrameDecodeResult::Corrupt);
+    TestTrue(TEXT("Frame after garbage"), decoder.Next(frame)==EFrameDecodeResult::Frame);
+    FServerReply reply;
+    TestTrue(TEXT("NACK parsed"), FRemoteClientProtocol::ParseReply(EWireProtocol::Text, frame, reply));
+    TestEqual(TEXT("NACK code"), (int32)reply.code, 0xFC);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FServerFrameDecoderWrapTest, "RemoteClient.Core.FrameDecoder.Wrap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/* More bytes than the ring holds, in chunks that never line up with the frames: frames wrapping the end come out whole */
+bool FServerFrameDecoderWrapTest::RunTest(const FString& Parameters){
+
+    FServerFrameDecoder decoder;
+    TArray<uint8> stream;
+    const int32 frames=3*FServerFrameDecoder::Capacity/12;
+    for(int32 i=0; i<frames; i++){
+        const uint8 ack[]={'!','s','-','_','A','C','K','-',(uint8)(i%200),'-','e','!'};
+        stream.Append(ack, sizeof(ack));
+    }
+
+    int32 decoded=0;
+    TArrayView<const uint8> frame;
+    for(int32 offset=0; offset<stream.Num(); offset+=7){
+        _Feed(decoder, stream.GetData()+offset, FMath::Min(7, stream.Num()-offset));
+        EFrameDecodeResult res;
+        while((res=decoder.Next(frame))!=EFrameDecodeResult::Incomplete){
+            if(res!=EFrameDecodeResult::Frame || frame.Num()!=12 || frame[8]!=(uint8)(decoded%200) || frame[11]!='!'){
+                AddError(FString::Printf(TEXT("Frame %d decoded wrong"), decoded));
+                return false;
+            }
+            decoded++;
+        }
+    }
+    TestEqual(TEXT("Every frame"), decoded, frames);
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FServerFrameDecoderBinaryTest, "RemoteClient.Core.FrameDecoder.Binary", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FServerFrameDecoderBinaryTest::RunTest(const FString& Parameters){
+
+    FServerFrameDecoder decoder;
+    decoder.SetBinaryFraming(true);
+    TArrayView<const uint8> frame;
+
+    const uint8 bytes[]={0x00, FRemoteClientProtocol::BINARY_SYNC, 4, FRemoteClientProtocol::BIN_ACK, 0x34, 0x12, FRemoteClientProtocol::STAGE_MCU};
+    _Feed(decoder, bytes, 4);
+    TestTrue(TEXT("Leading garbage"), decoder.Next(frame)==EFrameDecodeResult::Corrupt);
+    TestTrue(TEXT("Partial frame"), decoder.Next(frame)==EFrameDecodeResult::Incomplete);
+    _Feed(decoder, bytes+4, sizeof(bytes)-4);
+    TestTrue(TEXT("Complete frame"), decoder.Next(frame)==EFrameDecodeResult::Frame);
+
+    FServerReply reply;
+    TestTrue(TEXT("ACK parsed"), FRemoteClientProtocol::ParseReply(EWireProtocol::Binary, frame, reply));
+    TestTrue(TEXT("ACK type"), reply.type==EServerReply::ACK);
+    TestEqual(TEXT("ACK seq"), (int32)reply.seq, 0x1234);
+    TestEqual(TEXT("ACK stage"), (int32)reply.stage, (int32)FRemoteClientProtocol::STAGE_MCU);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
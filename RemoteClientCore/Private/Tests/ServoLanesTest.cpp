@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "ServoLanes.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/** Lane j of the word holds (Value + j*Step) & 0xFF, so every lane compares different values */
+static uint64 _Spread(int32 Value, int32 Step){
+    uint8 lanes[8];
+    for(int32 j=0; j<8; j++){
+        lanes[j]=(uint8)(Value+j*Step);
+    }
+    return ServoLanes::Load(lanes);
+}
+
+static uint8 _Lane(uint64 W, int32 j){ return (uint8)(W>>(8*j)); }
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FServoLanesCompareTest, "RemoteClient.Core.ServoLanes.Compare", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/* Every pair of byte values against the scalar result, with different values in the neighbour lanes */
+bool FServoLanesCompareTest::RunTest(const FString& Parameters){
+
+    int32 failures=0;
+    for(int32 a=0; a<256 && failures<10; a++){
+        for(int32 b=0; b<256 && failures<10; b++){
+            const uint64 A=_Spread(a, 37);
+            const uint64 B=_Spread(b, 91);
+            const uint64 ge=ServoLanes::GreaterOrEqual(A, B);
+            const uint64 ne=ServoLanes::NotEqual(A, B);
+            const uint64 maxW=ServoLanes::Max(A, B);
+            const uint64 minW=ServoLanes::Min(A, B);
+            const uint32 geMask=ServoLanes::HighBitsToMask(ge);
+            for(int32 j=0; j<8; j++){
+                const uint8 x=_Lane(A, j);
+                const uint8 y=_Lane(B, j);
+                const bool bOk=((_Lane(ge, j)==0x80)==(x>=y)) && ((_Lane(ne, j)==0x80)==(x!=y)) && (((geMask>>j)&1)==(x>=y ? 1u : 0u))
+                    && _Lane(maxW, j)==FMath::Max(x, y) && _Lane(minW, j)==FMath::Min(x, y)
+                    && (_Lane(ge, j)&0x7F)==0 && (_Lane(ne, j)&0x7F)==0;
+                if(!bOk){
+                    AddError(FString::Printf(TEXT("Lane %d: %d vs %d"), j, x, y));
+                    failures++;
+                }
+            }
+        }
+    }
+    return failures==0;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FServoLanesAddTest, "RemoteClient.Core.ServoLanes.AddEach", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FServoLanesAddTest::RunTest(const FString& Parameters){
+
+    const uint8 values[]={1, 127};
+    for(const uint8 v : values){
+        for(int32 a=0; a<256; a++){
+            const uint64 A=_Spread(a, 53);
+            const uint64 sum=ServoLanes::AddEach(A, v);
+            for(int32 j=0; j<8; j++){
+                if(_Lane(sum, j)!=(uint8)(_Lane(A, j)+v)){
+                    AddError(FString::Printf(TEXT("%d + %d gave %d"), _Lane(A, j), v, _Lane(sum, j)));
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FServoLanesTableTest, "RemoteClient.Core.ServoLanes.Table", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/* The 32 servo helpers: Differ, OutOfRange & Clamp over random tables */
+bool FServoLanesTableTest::RunTest(const FString& Parameters){
+
+    FRandomStream random(1234);
+    for(int32 run=0; run<1000; run++){
+        uint8 a[MAX_SERVOS];
+        uint8 b[MAX_SERVOS];
+        uint8 lo[MAX_SERVOS];
+        uint8 hi[MAX_SERVOS];
+        for(int32 i=0; i<MAX_SERVOS; i++){
+            a[i]=(uint8)random.RandRange(0, 255);
+            b[i]=random.RandRange(0, 3)==0 ? a[i] : (uint8)random.RandRange(0, 255);
+            lo[i]=(uint8)random.RandRange(1, 180);
+            hi[i]=(uint8)random.RandRange(lo[i], 180);
+        }
+        uint64 loWords[ServoLanes::WORDS];
+        uint64 hiWords[ServoLanes::WORDS];
+        for(int32 w=0; w<ServoLanes::WORDS; w++){
+            loWords[w]=ServoLanes::Load(lo+8*w);
+            hiWords[w]=ServoLanes::Load(hi+8*w);
+        }
+
+        uint32 differ=0;
+        uint32 outside=0;
+        uint8 clamped[MAX_SERVOS];
+        for(int32 i=0; i<MAX_SERVOS; i++){
+            differ|=(a[i]!=b[i] ? 1u : 0u)<<i;
+            outside|=(a[i]<lo[i] || a[i]>hi[i] ? 1u : 0u)<<i;
+            clamped[i]=FMath::Clamp(a[i], lo[i], hi[i]);
+        }
+        uint8 out[MAX_SERVOS];
+        ServoLanes::Clamp(a, loWords, hiWords, out);
+
+        TestTrue(TEXT("Differ"), ServoLanes::Differ(a, b)==differ);
+        TestTrue(TEXT("OutOfRange"), ServoLanes::OutOfRange(a, loWords, hiWords)==outside);
+        if(FMemory::Memcmp(out, clamped, MAX_SERVOS)!=0){
+            AddError(FString::Printf(TEXT("Clamp differs on run %d"), run));
+        }
+        if(HasAnyErrors()){
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
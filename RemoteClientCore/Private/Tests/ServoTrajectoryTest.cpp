@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "ServoTrajectory.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FServoTrajectoryTest, "RemoteClient.Core.Trajectory", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+/* Resampling: tracks start from the current position, only changed servos are emitted, finished tracks stop */
+bool FServoTrajectoryTest::RunTest(const FString& Parameters){
+
+    uint8 start[MAX_SERVOS];
+    FMemory::Memset(start, 1);
+    const FServoKeyframe keys[]={FServoKeyframe(1.f, 0, 100), FServoKeyframe(2.f, 3, 50)};
+
+    for(const ETrajectoryInterpolation interpolation : {ETrajectoryInterpolation::Linear, ETrajectoryInterpolation::Cubic}){
+        FTrajectoryScheduler trajectory;
+        trajectory.Load(MakeArrayView(keys), interpolation, false, 10.0, start);
+        TestTrue(TEXT("Playing"), trajectory.IsActive());
+
+        uint8 out[MAX_SERVOS]={};
+        TestTrue(TEXT("Nothing moved at the start"), trajectory.Sample(10.0, out)==0);
+
+        /* Halfway between the start (wire 1) & the key (wire 101): symmetric for both interpolations */
+        TestTrue(TEXT("Both servos move"), trajectory.Sample(10.5, out)==0x9u);
+        TestEqual(TEXT("Servo 0 halfway"), (int32)out[0], 51);
+        TestTrue(TEXT("Same sample, nothing new"), trajectory.Sample(10.5, out)==0);
+
+        TestTrue(TEXT("Servo 0 done"), trajectory.Sample(11.0, out)&0x1u);
+        TestEqual(TEXT("Servo 0 on its key"), (int32)out[0], 101);
+        TestTrue(TEXT("Servo 3 still playing"), trajectory.IsActive());
+
+        trajectory.Sample(12.0, out);
+        TestEqual(TEXT("Servo 3 on its key"), (int32)out[3], 51);
+        TestFalse(TEXT("Finished"), trajectory.IsActive());
+    }
+
+    /* Appended batches start where the playing one ends */
+    FTrajectoryScheduler trajectory;
+    const FServoKeyframe first[]={FServoKeyframe(1.f, 0, 100)};
+    const FServoKeyframe second[]={FServoKeyframe(1.f, 0, 0)};
+    trajectory.Load(MakeArrayView(first), ETrajectoryInterpolation::Linear, false, 0.0, start);
+    trajectory.Load(MakeArrayView(second), ETrajectoryInterpolation::Linear, true, 0.0, start);
+    uint8 out[MAX_SERVOS]={};
+    trajectory.Sample(1.0, out);
+    TestEqual(TEXT("First batch played in full"), (int32)out[0], 101);
+    trajectory.Sample(1.5, out);
+    TestEqual(TEXT("Second batch halfway"), (int32)out[0], 51);
+    return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
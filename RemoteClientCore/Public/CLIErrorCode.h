@@ -0,0 +1,35 @@
+
+#pragma once
+	
+#include "CoreMinimal.h"
+	
+/**
+ * Enum with the different Error codes the Remote Client System might take. Wrapped for Blueprints in RemoteClientTypes.h
+ */
+enum class ECLIErrorCode : uint8
+{
+	CLEAR 						=0,
+	GenericError 				=1,
+    ServerConnError             =2,
+    CorruptedICMU               =3,
+    NoServerConnection          =4,
+    ConnectTimeout              =5,
+    ServerTimeout               =6,
+    MCUTimeout                  =7,
+    StaleMCUInfo                =8,
+    Preempted                   =9,
+    PriorityTimeout             =10,
+
+	INVALID_SERVO_ID	   		=100,
+	INVALID_SERVO_POSITION 		=101,
+
+	NACK_InvalidQuery			=255,
+    NACK_NoActiveMCU			=254,
+    NACK_OnRTMode			    =253,
+    NACK_InvalidParameter		=252,
+    NACK_ServoCountMismatch		=251,
+    NACK_NoMCUInfo				=250,
+    NACK_MCUOffline				=249,
+    NACK_ErrorContactingMCU		=248,
+    NACK_ErrorLoadingMINMAX		=247
+};
\ No newline at end of file
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+	
+#include "CoreMinimal.h"
+	
+/**
+ * Enum with the different Client status codes the Remote Client System might take. Wrapped for Blueprints in RemoteClientTypes.h
+ */
+enum class ECLIStatusCode : uint8
+{
+	IDLE 						=0,
+	WAITING_SERVER_ACK			=1,
+	WAITING_MCU_ACK				=2,
+	STREAMING					=3,
+	SWITCHING_RT_MODE			=4,
+	SWITCHING_TELEMETRY			=5,
+	RETRIEVING_LIMITS			=248,
+	CONNECTING					=249,
+	NEGOTIATING_PROTOCOL		=250,
+	NO_SERVER_CONN				=251,
+	RETRIEVING_INFO				=252,
+	RETRIEVING_INFO_sMCU		=253,
+	ON_MCU_SELECT				=254,
+	STARTING_UP					=255
+};
\ No newline at end of file
@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+/* RemoteClient.Bench & RemoteClient.Replay console commands, development builds only */
+namespace RemoteClientBench
+{
+	/** Wraps GMalloc to count the allocations of a bench run. Start up only (-RemoteClientCountAllocs), never removed */
+	void InstallAllocationCounter();
+}
+
+#endif // !UE_BUILD_SHIPPING
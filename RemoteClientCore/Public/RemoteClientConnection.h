@@ -0,0 +1,365 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Containers/Queue.h"
+#include "Async/Future.h"
+#include "ServoInfo.h"
+#include "CLIErrorCode.h"
+#include "CLIStatusCode.h"
+#include "ServerFrameDecoder.h"
+#include "ServoStateTable.h"
+#include "RemoteClientProtocol.h"
+#include "RemoteClientStats.h"
+#include "ServoTrajectory.h"
+#include "RemoteClientTransport.h"
+
+class FSocket;
+class FRunnableThread;
+class FEvent;
+class FRemoteClientRecorder;
+
+/** Connection parameters, copied when the connection is opened */
+struct FRemoteClientSettings
+{
+	FString IpAdr;
+	int32 Port = 0;
+	ERemoteClientTransport Transport = ERemoteClientTransport::Tcp;
+	FString mcuName;
+	int32 MaxInFlightOrders = 1;       /* Over 1 only once the server confirmed it tags its ACKs (binary or SequencedText, at most 16), else stop-and-wait */
+	bool bUseBinaryProtocol = false;
+	int32 StreamUdpPort = 0;
+	float ConnectTimeoutS = 3.f;
+	float ServerTimeoutS = 2.f;         /* Query & server ACK replies */
+	float McuTimeoutS = 5.f;            /* Server ACK -> MCU ACK */
+	float PriorityTimeoutS = 0.5f;      /* Priority movement sent -> applied by the MCU, the connection is dropped past it */
+	bool bAutoReconnect = true;
+	float ReconnectMaxDelayS = 10.f;
+	int32 CoalesceWindowUs = 0;         /* Hold time of the first write of a burst, upper bound in adaptive mode */
+	bool bAdaptiveCoalescing = false;
+	int32 Deadband = -1;                /* Targets this close to the last position sent (not the MCU confirmed one) are dropped, -1 = off */
+	bool bWarmStart = true;             /* Accept movements from the cached MCU info until the iMCU of the start up */
+	bool bPipelineHandshake = true;     /* Log-in, sMCU, iMCU (& PROT) in one send instead of one round trip each */
+	ERemoteClientLimitMode LimitMode = ERemoteClientLimitMode::Reject;  /* Targets outside the MCU or user limits, see SetServoLimits */
+};
+
+/**
+ * Server connection of the remote client system.
+ * One long-lived thread owns the socket and runs every query on it. Other threads post commands through a lock-free
+ * queue and exchange servo data through the pending/current position tables, so no call ever blocks on the network.
+ * Operations return a future, fulfilled by the connection thread with CLEAR or the error/NACK code that ended them.
+ */
+class REMOTECLIENTCORE_API FRemoteClientConnection : public FRunnable
+{
+	public:
+
+		/** OnServosMoved is called on the connection thread when telemetry moves a servo & the previous moves were taken */
+		explicit FRemoteClientConnection(TFunction<void()> OnServosMoved=nullptr);
+		virtual ~FRemoteClientConnection();
+
+		/* Thread safe, executed in order by the connection thread */
+		TFuture<ECLIErrorCode> Connect(const FRemoteClientSettings& Settings);   /* Done once the MCU is selected & retrieved */
+		void Disconnect();
+		TFuture<ECLIErrorCode> SelectMCU(const FString& MCU_Name);               /* Done once the new MCU is retrieved */
+		TFuture<ECLIErrorCode> RetrieveMCUInfo();
+		TFuture<ECLIErrorCode> ClearErr();                                        /* Done once applied, movements are refused until then */
+
+		/** Real time mode: setpoints are streamed at a fixed rate without MCU ACKs, latest value wins for each servo */
+		void StartStreaming(float RateHz, bool bUseUDP);
+		void StopStreaming();
+
+		/* Thread safe, queued into the pending movement table. False if refused: error state or invalid batch, see GetErr */
+		bool SendMovement(TArrayView<const FServoInfo> servoMovements);
+		/** Packed batch: servo i moves to positions[i] (0-179) for every bit i of mask, the other slots are ignored */
+		bool SendMovement(uint32 mask, const uint8 (&positions)[MAX_SERVOS]);
+		/** Same with positions already in wire units (1-180), as produced by FServoPoseConverter */
+		bool SendWireMovement(uint32 mask, const uint8 (&wirePositions)[MAX_SERVOS]);
+
+		/**
+		 * Same as SendMovement, the future is fulfilled once the MCU completed the order carrying these targets (or once they
+		 * were streamed in real time mode). A NACK or a lost connection fails every movement sent before it.
+		 */
+		TFuture<ECLIErrorCode> SendMovementAsync(TArrayView<const FServoInfo> servoMovements);
+		TFuture<ECLIErrorCode> SendMovementAsync(uint32 mask, const uint8 (&positions)[MAX_SERVOS]);
+
+		/**
+		 * Thread safe. Range (0-179) each servo's movements are validated against, the full range until set.
+		 * Unless LimitMode is Off the MCU limits (lMCU, retrieved once per MCU during the start up) narrow it down further
+		 */
+		void SetServoLimits(const uint8 (&MinPositions)[MAX_SERVOS], const uint8 (&MaxPositions)[MAX_SERVOS]);
+
+		/** Thread safe. Limits (0-179) the movements are checked or clamped against: user & MCU limits combined */
+		void GetServoLimits(uint8 (&OutMin)[MAX_SERVOS], uint8 (&OutMax)[MAX_SERVOS]) const;
+
+		/**
+		 * Priority lane, thread safe. The targets skip the pending table, the coalescing window, the deadband & the order window:
+		 * they go out on the next pass of the connection thread, even during a query (held only during the start up & a real
+		 * time mode switch), & the server hands them to the MCU ahead of the queued orders.
+		 * bCancelPending drops the movements not completed yet (pending or in flight, their futures fail with Preempted) & stops
+		 * the trajectory. Accepted in error state too, fulfilled once the MCU applied the targets
+		 */
+		TFuture<ECLIErrorCode> SendPriorityMovement(TArrayView<const FServoInfo> servoMovements, bool bCancelPending);
+
+		/** Priority movement of every servo to its current position, cancelling the rest: stops the robot where it is. StaleMCUInfo before the first iMCU */
+		TFuture<ECLIErrorCode> HoldPosition();
+
+		/** Thread safe. Keyframes are interpolated on the connection thread & resampled at RateHz into the pending movement table */
+		void PlayTrajectory(TArrayView<const FServoKeyframe> Keyframes, ETrajectoryInterpolation Interpolation, bool bAppend, float RateHz);
+		void StopTrajectory();
+		bool IsTrajectoryPlaying() const { return trajectoryPlaying.load(); }
+
+		/**
+		 * Asks the server to push the measured servo positions at RateHz (0 unsubscribes), kept across reconnections.
+		 * Pushed positions go straight into the current positions, whatever the connection is doing.
+		 */
+		TFuture<ECLIErrorCode> SubscribeTelemetry(float RateHz);
+
+		/** Records the movement frames sent & the replies received from now on, nullptr stops. Thread safe */
+		void SetRecorder(TSharedPtr<FRemoteClientRecorder, ESPMode::ThreadSafe> Recorder);
+
+		/** False until the MCU limits were retrieved (lMCU) or loaded from the cache, and for good once the server refused lMCU */
+		bool HasMCULimits() const { return servos.HasMCULimits(); }
+
+		/** True while movement targets wait to be taken into an order */
+		bool HasPendingMovement() const { return servos.HasPending(); }
+
+		/** Servos moved by telemetry since the last call */
+		uint32 TakeMovedServos() { return movedServos.exchange(0); }
+
+		/** Lock-free, refreshes the snapshot only if the servo positions changed since it was taken */
+		bool ReadServoPositions(FServoPositionSnapshot& InOutSnapshot) const { return servos.ReadSnapshot(InOutSnapshot); }
+
+		/** Latency histograms & counters, recorded lock-free by the connection thread */
+		FRemoteClientStats& GetStats() { return stats; }
+		const FRemoteClientStats& GetStats() const { return stats; }
+
+		ECLIErrorCode GetErr() const { return errCode.load(); }
+		uint32 GetThreadId() const;
+		ECLIStatusCode GetStatus() const { return status.load(); }
+
+		/* FRunnable */
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+
+	private:
+
+		enum class ECommand : uint8
+		{
+			Connect,
+			Disconnect,
+			SelectMCU,
+			RetrieveMCUInfo,
+			ClearErr,
+			StartStreaming,
+			StopStreaming,
+			PlayTrajectory,
+			StopTrajectory,
+			SubscribeTelemetry,
+			SetRecorder
+		};
+
+		struct FCommand
+		{
+			ECommand type;
+			FString arg;
+			FRemoteClientSettings settings;
+			float value = 0;
+			bool bFlag = false;
+			TArray<FServoKeyframe> keyframes;
+			ETrajectoryInterpolation interpolation = ETrajectoryInterpolation::Linear;
+			TUniquePtr<TPromise<ECLIErrorCode>> promise;    /* Async operations only */
+			TSharedPtr<FRemoteClientRecorder, ESPMode::ThreadSafe> recorder;
+		};
+
+		/* SendMovementAsync caller, done once every movement up to its ticket is */
+		struct FMovementWaiter
+		{
+			uint64 ticket;
+			TPromise<ECLIErrorCode> promise;
+		};
+
+		struct FFailedRange
+		{
+			uint64 fromTicket;
+			uint64 toTicket;
+			ECLIErrorCode code;
+		};
+
+		/* Priority lane entry, see SendPriorityMovement */
+		struct FPriorityMovement
+		{
+			uint32 mask = 0;
+			uint8 positions[MAX_SERVOS];   /* Only valid where mask is set */
+			bool bCancelPending = false;
+			bool bHold = false;            /* Positions taken from the current ones when sent */
+			uint64 queuedCycles = 0;
+			uint64 sentCycles = 0;
+			TPromise<ECLIErrorCode> promise;
+		};
+
+		/* Movement order on the wire, waiting for its server & MCU ACKs */
+		struct FInFlightOrder
+		{
+			uint16 seq;
+			bool serverAcked;
+			bool mcuAcked;
+			uint32 mask;                   /* Servos moved by this order */
+			uint8 positions[MAX_SERVOS];   /* Targets, only valid where mask is set */
+			uint64 queuedCycles;           /* Oldest SendMovement coalesced into the order, 0 if unknown */
+			uint64 sentCycles;
+			uint64 serverAckCycles;
+			uint64 ticket;                 /* Every movement up to this ticket was taken into this order or an older one */
+			bool cancelled;                /* Dropped by a priority movement, only tracked until its UACK */
+		};
+
+		FRunnableThread* thread = nullptr;
+		FEvent* wakeEvent = nullptr;
+		std::atomic<bool> stopping = false;
+		TQueue<FCommand, EQueueMode::Mpsc> commands;
+		TQueue<FPriorityMovement, EQueueMode::Mpsc> priorityMovements;    /* Never waits behind the commands */
+
+		/* Connection thread only */
+		FRemoteClientSettings settings;
+		TUniquePtr<IRemoteClientTransport> transport;
+		FServerFrameDecoder decoder;
+		TArray<uint8> outBuffer;           /* Frames are built in place here, until the non-blocking socket accepts them */
+		TArray<FInFlightOrder, TInlineAllocator<16>> inFlightOrders; /* Oldest first */
+		TArray<FPriorityMovement, TInlineAllocator<4>> priorityInFlight; /* Oldest first, answered in send order */
+		uint16 nextOrderSeq = 0;
+		EWireProtocol protocol = EWireProtocol::Text;
+		bool sequencedOrders = false;      /* ACKs carry the order sequence (binary, or SequencedText ACKed): the order window is open */
+		FString selectedMCU;
+
+		std::atomic<bool> err = true;
+		std::atomic<ECLIErrorCode> errCode = ECLIErrorCode::NoServerConnection;
+		std::atomic<ECLIStatusCode> status = ECLIStatusCode::NO_SERVER_CONN;
+
+		FServoStateTable servos; /* Pending & current positions, shared lock-free with the callers */
+		std::atomic<ERemoteClientLimitMode> limitMode = ERemoteClientLimitMode::Reject;  /* Copy of the setting for the calling threads */
+		FRemoteClientStats stats;
+
+		/* Completion of the async operations */
+		std::atomic<uint64> movementTicket = 0;           /* Bumped by every SendMovement, after its targets are pending */
+		TQueue<FMovementWaiter, EQueueMode::Mpsc> newMovementWaiters;
+		TUniquePtr<TPromise<ECLIErrorCode>> queryPromise;  /* Connection thread only from here on */
+		TArray<FMovementWaiter> movementWaiters;
+		std::atomic<int32> queueingWaiters = 0;           /* SendMovementAsync calls between their ticket & their waiter */
+		uint64 completedTicket = 0;
+		TArray<FFailedRange> failedRanges;                 /* Failures not settled yet: tickets in ]from, to] failed with code */
+
+		/* Timeouts & reconnection, connection thread only */
+		double connectDeadline = 0;
+		double replyDeadline = 0;           /* Pending query (PROT, sMCU, iMCU, RTMD) */
+		double reconnectAt = 0;             /* 0 = no reconnection scheduled */
+		float reconnectDelay = 0;
+		FRandomStream reconnectJitter;
+
+		bool warmStarted = false;           /* Servo table loaded from the cache, waiting for the iMCU to confirm it. Connection thread only */
+
+		/* MCU limits, connection thread only */
+		FString limitsMCU;                  /* MCU the limits of the servo table belong to, empty = full range */
+		bool limitsRetrieved = false;       /* lMCU answered on the current server session */
+
+		/* Pipelined handshake, connection thread only. Replies come back in send order: sMCU, iMCU, then PROT */
+		bool infoQueued = false;            /* iMCU sent behind the pending sMCU */
+		bool protocolQueued = false;        /* Binary offer sent behind the start up queries, answered last */
+		int32 discardReplies = 0;           /* Answers to queries pipelined behind a failed one */
+
+		/* Startup timing, connection thread only */
+		uint64 startupCycles = 0;           /* Connect start, 0 once the startup sequence is over */
+		uint64 queryCycles = 0;             /* Last sMCU / iMCU query sent */
+
+		/* Real time streaming, connection thread only */
+		bool streamOn = false;              /* Requested real time mode, confirmed by the RTMD ACK */
+		bool streamUDP = false;
+		double streamPeriod = 0.01;
+		double nextStreamTick = 0;
+		uint16 streamSeq = 0;
+		uint32 streamMask = 0;              /* Servos with a setpoint since streaming started */
+		uint8 streamSetpoints[MAX_SERVOS];
+		FSocket* udpSck = nullptr;
+		TSharedPtr<FInternetAddr> udpAddr;
+		TArray<uint8> datagram;
+
+		/* Coalescing & deadband, connection thread only */
+		uint8 commanded[MAX_SERVOS];        /* Last position sent for each servo, or retrieved */
+		double coalesceDeadline = 0;        /* Pending writes held until then, 0 = none */
+		double orderRttS = 0;               /* Smoothed send -> MCU ACK time of the orders */
+
+		/* Telemetry */
+		uint16 telemetryRateHz = 0;         /* Subscribed rate, 0 = off. Connection thread only */
+		bool telemetryOn = false;           /* Subscribed on the current server session. Connection thread only */
+		std::atomic<uint32> movedServos = 0;
+		TFunction<void()> onServosMoved;
+
+		TSharedPtr<FRemoteClientRecorder, ESPMode::ThreadSafe> recorder;    /* Connection thread only */
+
+		/* Trajectory playback, connection thread only */
+		FTrajectoryScheduler trajectory;
+		double trajectoryPeriod = 0.02;
+		double nextTrajectoryTick = 0;
+		std::atomic<bool> trajectoryPlaying = false;
+
+		uint64 _QueueMovement(TArrayView<const FServoInfo> servoMovements);
+		uint64 _QueueMovement(uint32 mask, const uint8 (&positions)[MAX_SERVOS]);
+		uint64 _QueueWire(uint32 mask, const uint8 (&wire)[MAX_SERVOS]);
+		TFuture<ECLIErrorCode> _WaitForMovement(uint64 ticket);
+		void _Execute(FCommand& cmd);
+		static void _Reject(FCommand& cmd, ECLIErrorCode code);
+		bool _IsQueryPending() const;
+		void _SettleQuery();
+		void _FailMovements(ECLIErrorCode code);
+		void _SettleMovements();
+		void _SettleAll();
+		bool _IsBusy() const;
+		bool _IsReplyExpected() const;
+		void _OpenConnection();
+		void _PollConnect();
+		void _OnConnected();
+		void _CloseConnection();
+		void _ConnectionLost(ECLIErrorCode code);
+		void _ScheduleReconnect();
+		void _CheckTimeouts();
+		void _ArmReplyTimeout();
+		void _StartSelectMCU(const FString& MCU_Name);
+		void _StartRetrieveMCUInfo();
+		void _SendPendingMovements();
+		TFuture<ECLIErrorCode> _QueuePriority(FPriorityMovement&& movement);
+		void _SendPriorityMovements();
+		void _CancelPending();
+		void _HandlePriorityReply(const FServerReply& reply);
+		void _FailPriority(ECLIErrorCode code);
+		double _CoalesceWindowS() const;
+		EWireProtocol _ProtocolOffer() const;
+		int32 _OrderWindow() const;
+		uint32 _ApplyDeadband(uint32 mask, const uint8 (&targets)[MAX_SERVOS]);
+		void _ResyncCommanded();
+		void _Poll();
+		void _ReadSocket();
+		void _HandleFrame(TArrayView<const uint8> frame);
+		void _HandleCorruptFrame();
+		void _HandleProtocolReply(const FServerReply& reply);
+		void _HandleRealTimeModeReply(const FServerReply& reply);
+		void _StartStreaming(float RateHz, bool bUseUDP);
+		void _StreamTick();
+		bool _SendSetpoints(uint32 mask);
+		void _CloseStreamSocket();
+		void _TrajectoryTick();
+		double _SecondsToNextTick() const;
+		void _HandleSelectReply(const FServerReply& reply);
+		void _HandleInfoReply(const FServerReply& reply);
+		void _StartupDone();
+		void _StartRetrieveLimits();
+		void _HandleLimitsReply(const FServerReply& reply);
+		bool _LoadCachedLimits(const FString& MCU_Name);
+		void _WarmStart();
+		void _ReconcileWarmStart(const uint8* positions, uint8 count);
+		void _StartTelemetry();
+		void _HandleTelemetryReply(const FServerReply& reply);
+		void _HandleTelemetry(const FServerReply& reply);
+		bool _HandleOrderReply(const FServerReply& reply);
+		void _UpdateOrderStatus();
+		bool _FlushSend();
+};
@@ -0,0 +1,8 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* Shared by the core & the RemoteClientSystem adapter, the category keeps its name for existing log filters */
+REMOTECLIENTCORE_API DECLARE_LOG_CATEGORY_EXTERN(LogRemoteClientSystem, Log, All);
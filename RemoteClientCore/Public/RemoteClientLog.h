@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "RemoteClientProtocol.h"
+
+class FRunnableThread;
+class FEvent;
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+class FRemoteClientConnection;
+
+/**
+ * Command stream log: FRemoteClientLogHeader, then records back to back until the end of the file.
+ * Every record is a FRemoteClientLogRecord followed by the frame bytes, padded to 8 bytes, all little endian, so a
+ * memory-mapped log is walked in place. A log cut short by a crash is valid up to its last complete record.
+ */
+struct FRemoteClientLogHeader
+{
+	static constexpr uint32 MAGIC = 0x474C4352;    /* "RCLG" */
+	static constexpr uint32 VERSION = 1;
+
+	uint32 magic;
+	uint32 version;
+	int64 startUnixUs;      /* Wall clock of the first timestamp, for reference only */
+};
+
+enum class ERemoteClientLogDirection : uint8
+{
+	Sent = 0,               /* Movement frame */
+	Received = 1            /* ACK, NACK or iMCU frame */
+};
+
+struct FRemoteClientLogRecord
+{
+	uint64 timeUs;          /* Since the recording started */
+	uint16 len;             /* Frame bytes following the record */
+	ERemoteClientLogDirection direction;
+	EWireProtocol protocol;
+	uint32 reserved;
+};
+
+static_assert(sizeof(FRemoteClientLogHeader)==16 && sizeof(FRemoteClientLogRecord)==16, "Log layout is part of the file format");
+
+/**
+ * Appends frames to a command stream log, thread safe & cheap on the caller side.
+ * Record copies the frame into a memory buffer under a short lock; a writer thread swaps the buffers & writes them to
+ * the file in the background, so the connection thread never waits on the disk. Everything is written on destruction.
+ */
+class REMOTECLIENTCORE_API FRemoteClientRecorder : public FRunnable
+{
+	public:
+
+		explicit FRemoteClientRecorder(const FString& InPath);
+		virtual ~FRemoteClientRecorder();
+
+		/** Creates the file & starts the writer thread. Returns false if the file could not be created */
+		bool Start();
+
+		void Record(ERemoteClientLogDirection Direction, EWireProtocol Protocol, TArrayView<const uint8> Frame);
+
+		const FString& GetPath() const { return path; }
+		uint64 GetDroppedRecords() const { return dropped.load(std::memory_order_relaxed); }
+
+		/* FRunnable */
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+
+	private:
+
+		FString path;
+		IFileHandle* file = nullptr;
+		FRunnableThread* thread = nullptr;
+		FEvent* wakeEvent = nullptr;
+		std::atomic<bool> stopping = false;
+		uint64 startCycles = 0;
+		std::atomic<uint64> dropped = 0;    /* Records lost because the disk could not keep up */
+
+		FCriticalSection lock;
+		TArray<uint8> front;                /* Filled by Record, under lock */
+		TArray<uint8> back;                 /* Written by the writer thread */
+
+		void _WriteBack();
+};
+
+/**
+ * Streams the movement frames of a log back through a connection, on its own thread.
+ * At Speed > 0 the recorded timing is kept (scaled by Speed), at 0 every movement is sent as soon as the connection
+ * took the previous one, which turns a recorded session into a load test.
+ */
+class REMOTECLIENTCORE_API FRemoteClientReplayer : public FRunnable
+{
+	public:
+
+		explicit FRemoteClientReplayer(FRemoteClientConnection& InConnection);
+		virtual ~FRemoteClientReplayer();
+
+		/** Maps the log & starts replaying it. Returns false if the file is not a readable log */
+		bool Start(const FString& Path, float InSpeed);
+
+		bool IsRunning() const { return running.load(); }
+		int32 GetReplayedMovements() const { return replayed.load(); }
+
+		/* FRunnable */
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+
+	private:
+
+		FRemoteClientConnection& connection;
+		TUniquePtr<IMappedFileHandle> mappedFile;
+		TUniquePtr<IMappedFileRegion> mappedRegion;
+		FRunnableThread* thread = nullptr;
+		float speed = 1.f;
+		std::atomic<bool> stopping = false;
+		std::atomic<bool> running = false;
+		std::atomic<int32> replayed = 0;
+};
@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServoStateTable.h"
+
+/** Wire protocol version, negotiated right after log-in (!s-PROT-v-e!) */
+enum class EWireProtocol : uint8
+{
+	Text			= 1,	/* "!s-XXXX-c-...-e!" frames */
+	Binary			= 2,	/* [sync][len][type][payload] frames */
+	SequencedText	= 3		/* Text frames, the server echoes the SRVQ sequence tag in the code byte of both its ACKs */
+};
+
+enum class EServerReply : uint8
+{
+	Unknown,
+	ACK,
+	NACK,
+	iMCU,
+	Telemetry,      /* Pushed by the server once subscribed, never a query reply */
+	Priority,       /* Answer to a priority movement, in between any replies */
+	Limits          /* lMCU reply, per servo position limits */
+};
+
+/**
+ * Writes one frame in place at the end of a byte buffer: a single capacity check for the frame's worst case, then raw
+ * stores, and the buffer is trimmed to what was written when the writer goes out of scope. The buffer keeps its
+ * allocation, so a buffer reserved once never allocates again.
+ */
+class REMOTECLIENTCORE_API FFrameWriter
+{
+	public:
+
+		FFrameWriter(TArray<uint8>& InOut, int32 MaxLen)
+			: out(InOut), start(InOut.Num())
+		{
+			out.AddUninitialized(MaxLen);
+			begin=out.GetData()+start;
+			cursor=begin;
+		}
+		~FFrameWriter(){ out.SetNum(start+(int32)(cursor-begin), false); }
+
+		/** Compile-time sized copy of a string literal, without its terminator */
+		template<int32 N>
+		FORCEINLINE void Literal(const char (&Text)[N]){ FMemory::Memcpy(cursor, Text, N-1); cursor+=N-1; }
+
+		FORCEINLINE void Byte(uint8 Value){ *cursor++=Value; }
+		FORCEINLINE void Bytes(const uint8* Data, int32 Len){ FMemory::Memcpy(cursor, Data, Len); cursor+=Len; }
+		FORCEINLINE void U16(uint16 Value){ Byte((uint8)(Value&0xFF)); Byte((uint8)(Value>>8)); }
+		FORCEINLINE void U32(uint32 Value){ U16((uint16)(Value&0xFFFF)); U16((uint16)(Value>>16)); }
+
+	private:
+
+		TArray<uint8>& out;
+		int32 start;
+		uint8* begin;
+		uint8* cursor;
+};
+
+/** Server frame decoded into its fields, views point into the decoder buffer */
+struct FServerReply
+{
+	EServerReply type = EServerReply::Unknown;
+	uint8 code = 0;                     /* NACK error code / text ACK code byte (order seq on SRVQ) / priority result, 0 = done */
+	uint16 seq = 0;                     /* Binary only: order sequence */
+	uint8 stage = 0;                    /* Binary ACK only: 1 = accepted by server, 2 = completed by MCU */
+	uint8 servoCount = 0;               /* iMCU, telemetry & limits only */
+	const uint8* servoData = nullptr;   /* iMCU & telemetry: 2 bytes per servo, position (1-180) first. Limits: 3 bytes per servo, min & max (1-180) first */
+	int32 servoDataLen = 0;
+};
+
+/**
+ * Frame encoding & decoding for both wire protocols.
+ *
+ * Binary frames:  [0xB7][len][type][payload]  with len = bytes after the len byte (type + payload), little endian fields
+ *   client -> server   0x01 SRVP [seq u16][servo mask u32][one position (1-180) per set bit, lowest id first]
+ *                      0x02 sMCU [mcu name]
+ *                      0x03 iMCU
+ *                      0x04 RTMD [on u8]                       real time mode switch, ACKed
+ *                      0x05 RTSP [seq u16][servo mask u32][positions]  real time setpoint, never ACKed
+ *                      0x06 TLMS [rate u16]                    telemetry subscription in Hz, 0 = off, ACKed
+ *                      0x07 SRVU [flags u8][servo mask u32][positions]  priority movement, ahead of the queued orders
+ *                      0x08 lMCU                               position limits of the selected MCU's servos
+ *   server -> client   0x80 ACK  [seq u16][stage u8]   (seq 0 & stage 1 for non-movement queries)
+ *                      0x81 NACK [seq u16][code u8]
+ *                      0x82 iMCU [count u8][2 bytes per servo]
+ *                      0x83 TLMD [count u8][2 bytes per servo] telemetry, pushed at the subscribed rate
+ *                      0x84 UACK [code u8]                     priority movement applied by the MCU (0) or refused (NACK code)
+ *                      0x85 lMCU [count u8][3 bytes per servo] min & max position (1-180) then a reserved byte
+ */
+class REMOTECLIENTCORE_API FRemoteClientProtocol
+{
+	public:
+
+		static constexpr uint8 BINARY_SYNC = 0xB7;
+		static constexpr int32 BINARY_HEADER_LEN = 3;
+
+		/* Worst cases, every servo moved: text SRVQ !s-SRVQ-c-q- + 4 bytes per servo + e! (the binary frame is shorter) */
+		static constexpr int32 MAX_MOVEMENT_FRAME_LEN = 12+4*MAX_SERVOS+2;
+		static constexpr int32 MAX_MCU_NAME_LEN = 240;
+		static constexpr int32 MAX_FRAME_LEN = 256;
+
+		/* Text SRVQ tags: seq modulo 32 as 0-9 A-V, never a delimiter byte ('-', '!', 'e'). The window stays far below so tags never alias */
+		static constexpr int32 TEXT_SEQ_TAGS = 32;
+		static constexpr int32 MAX_TEXT_ORDER_WINDOW = 16;
+		static constexpr uint8 TextSeqTag(uint16 seq){ return (uint8)(seq%TEXT_SEQ_TAGS<10 ? '0'+seq%TEXT_SEQ_TAGS : 'A'+seq%TEXT_SEQ_TAGS-10); }
+
+		enum EBinaryType : uint8
+		{
+			BIN_SRVP = 0x01,
+			BIN_sMCU = 0x02,
+			BIN_iMCU_QUERY = 0x03,
+			BIN_RTMD = 0x04,
+			BIN_RTSP = 0x05,
+			BIN_TLMS = 0x06,
+			BIN_SRVU = 0x07,
+			BIN_lMCU_QUERY = 0x08,
+			BIN_ACK = 0x80,
+			BIN_NACK = 0x81,
+			BIN_iMCU = 0x82,
+			BIN_TLMD = 0x83,
+			BIN_UACK = 0x84,
+			BIN_lMCU = 0x85
+		};
+
+		/* Priority movement flags */
+		static constexpr uint8 PRIORITY_CANCEL_QUEUED = 0x01;   /* Orders the MCU did not complete yet are dropped, never answered */
+
+		enum EAckStage : uint8
+		{
+			STAGE_SERVER = 1,
+			STAGE_MCU = 2
+		};
+
+		/* Builders append a complete frame to Out */
+		static void AppendLogin(TArray<uint8>& Out);
+		/** !s-PROT-v-e!, ACKed with code v if the server supports it. Servers that do not know PROT NACK it */
+		static void AppendProtocolQuery(TArray<uint8>& Out, EWireProtocol Requested);
+		static void AppendSelectMCU(TArray<uint8>& Out, EWireProtocol Protocol, const FString& MCU_Name);
+		static void AppendInfoQuery(TArray<uint8>& Out, EWireProtocol Protocol);
+		/** Position limits query: text !s-lMCU-e!, answered by !s-lMCU-n-min max - ...e! (or a NACK from servers without limits) */
+		static void AppendLimitsQuery(TArray<uint8>& Out, EWireProtocol Protocol);
+		/** Text: SRVP, or SRVQ tagged with TextSeqTag(seq) when bSequenced. Binary: always sequenced */
+		static void AppendMovement(TArray<uint8>& Out, EWireProtocol Protocol, uint16 seq, bool bSequenced, uint32 mask, const uint8 (&positions)[MAX_SERVOS]);
+
+		/**
+		 * Priority movement: text !s-SRVU-c-f-...e! with f = flags, answered once by !s-UACK-r-e! (r = 0 or a NACK code).
+		 * The server hands it to the MCU ahead of the orders it queued, and answers it ahead of them too
+		 */
+		static void AppendPriorityMovement(TArray<uint8>& Out, EWireProtocol Protocol, uint8 flags, uint32 mask, const uint8 (&positions)[MAX_SERVOS]);
+
+		/** Real time mode switch: text !s-RTMD-b-e! with b = 1/0 */
+		static void AppendRealTimeMode(TArray<uint8>& Out, EWireProtocol Protocol, bool bOn);
+		/** Real time setpoint: text !s-RTSP-c-ss-id:pos-...e! with ss = seq (little endian) */
+		static void AppendSetpoint(TArray<uint8>& Out, EWireProtocol Protocol, uint16 seq, uint32 mask, const uint8 (&positions)[MAX_SERVOS]);
+
+		/** Telemetry subscription: text !s-TLMS-rr-e! with rr = rate in Hz (little endian), 0 unsubscribes. Pushed back as !s-TLMD-n-...e! */
+		static void AppendTelemetryRequest(TArray<uint8>& Out, EWireProtocol Protocol, uint16 RateHz);
+
+		/** Returns false if the frame is not a valid server reply */
+		static bool ParseReply(EWireProtocol Protocol, TArrayView<const uint8> frame, FServerReply& Out);
+
+		/** Reads a movement frame of AppendMovement back into its mask & positions (1-180), false if it is not one */
+		static bool ParseMovement(EWireProtocol Protocol, TArrayView<const uint8> frame, uint32& OutMask, uint8 (&OutPositions)[MAX_SERVOS]);
+
+	private:
+
+		static bool _ParseText(TArrayView<const uint8> frame, FServerReply& Out);
+		static bool _ParseBinary(TArrayView<const uint8> frame, FServerReply& Out);
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformMemory.h"
+#include "RemoteClientTransport.h"
+
+/**
+ * Single producer / single consumer byte ring living in shared memory.
+ * head is only written by the producer, tail only by the consumer, each on its own cache line: no lock and no syscall,
+ * the bytes are copied straight into & out of the ring. Indices run freely & wrap, the capacity is a power of two.
+ */
+struct FSharedMemoryRing
+{
+	static constexpr uint32 CAPACITY = 64*1024;
+
+	alignas(64) std::atomic<uint32> head;   /* Bytes written */
+	alignas(64) std::atomic<uint32> tail;   /* Bytes read */
+	alignas(64) uint8 data[CAPACITY];
+
+	/** Producer. Returns the bytes written, less than Len when the ring is full */
+	int32 Write(const uint8* Src, int32 Len);
+
+	/** Consumer. Returns the bytes read, 0 if the ring is empty */
+	int32 Read(uint8* Dst, int32 MaxLen);
+
+	bool IsEmpty() const { return head.load(std::memory_order_acquire)==tail.load(std::memory_order_relaxed); }
+};
+
+/**
+ * Shared region of one server endpoint, named after its port. The server creates it & listens, a client connects by
+ * raising clientState, the server resets both rings & accepts. Either side leaving ends the session.
+ */
+struct FSharedMemoryChannel
+{
+	static constexpr uint32 MAGIC = 0x4D485352;     /* "RSHM" */
+	static constexpr uint32 VERSION = 1;
+
+	/* serverState & clientState */
+	static constexpr uint32 STATE_NONE = 0;
+	static constexpr uint32 STATE_OPEN = 1;         /* Server listening, client connecting */
+	static constexpr uint32 STATE_SESSION = 2;      /* Server accepted, client connected */
+	static constexpr uint32 STATE_CLOSED = 3;
+
+	uint32 magic;
+	uint32 version;
+	alignas(64) std::atomic<uint32> serverState;
+	std::atomic<uint32> session;        /* Bumped by every accept, a client only closes its own session */
+	alignas(64) std::atomic<uint32> clientState;
+	FSharedMemoryRing toServer;
+	FSharedMemoryRing toClient;
+
+	static FString GetName(int32 Port);
+};
+
+static_assert(std::atomic<uint32>::is_always_lock_free, "Ring indices are shared between processes");
+
+/** Client end of a shared memory channel, see FSharedMemoryChannel */
+class REMOTECLIENTCORE_API FSharedMemoryTransport final : public IRemoteClientTransport
+{
+	public:
+
+		virtual ~FSharedMemoryTransport();
+
+		/** Address is ignored, the server has to run on this machine */
+		virtual bool Connect(const FString& Address, int32 Port) override;
+		virtual ETransportConnectState PollConnect(FTimespan Wait) override;
+		virtual bool WaitForRead(FTimespan Wait) override;
+		virtual bool Send(const uint8* Data, int32 Len, int32& OutSent) override;
+		virtual bool Recv(uint8* Data, int32 MaxLen, int32& OutRead) override;
+
+	private:
+
+		FPlatformMemory::FSharedMemoryRegion* region = nullptr;
+		FSharedMemoryChannel* channel = nullptr;
+		uint32 session = 0;
+
+		bool _IsServerGone() const;
+};
+
+/**
+ * Server end of a shared memory channel, for a local server (see FRemoteMockServer). One client at a time.
+ * The accepted transport only speaks Send/Recv/WaitForRead, it does not connect.
+ */
+class REMOTECLIENTCORE_API FSharedMemoryListener
+{
+	public:
+
+		~FSharedMemoryListener();
+
+		/** Creates the region of Port. Returns false if it could not be created */
+		bool Listen(int32 Port);
+
+		/** Waits up to Wait for a client, null if none connected */
+		TUniquePtr<IRemoteClientTransport> Accept(FTimespan Wait);
+
+	private:
+
+		FPlatformMemory::FSharedMemoryRegion* region = nullptr;
+		FSharedMemoryChannel* channel = nullptr;
+};
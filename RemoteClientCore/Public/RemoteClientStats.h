@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CLIErrorCode.h"
+
+/**
+ * Latency percentiles of one phase, in milliseconds. This & FRemoteClientStatsInfo are wrapped for Blueprints in RemoteClientTypes.h
+ */
+struct FRemoteClientLatencyInfo
+{
+    int64 Count = 0;
+    float MeanMs = 0.f;
+    float P50Ms = 0.f;
+    float P90Ms = 0.f;
+    float P99Ms = 0.f;
+    float MaxMs = 0.f;
+};
+
+/**
+ * Stats of the remote client since the last reset.
+ * Order phases: Queue = SendMovement -> on the wire, ServerAck = on the wire -> server ACK, McuAck = server ACK -> MCU ACK,
+ * Order = SendMovement -> MCU ACK. Startup phases: Connect = TCP connect, SelectMCU = sMCU -> ACK, MCUInfo = iMCU -> reply,
+ * Startup = connect -> client idle. Priority = SendPriorityMovement -> applied by the MCU, on its own lane.
+ */
+struct FRemoteClientStatsInfo
+{
+    FRemoteClientLatencyInfo Queue;
+    FRemoteClientLatencyInfo ServerAck;
+    FRemoteClientLatencyInfo McuAck;
+    FRemoteClientLatencyInfo Order;
+    FRemoteClientLatencyInfo Connect;
+    FRemoteClientLatencyInfo SelectMCU;
+    FRemoteClientLatencyInfo MCUInfo;
+    FRemoteClientLatencyInfo Startup;
+    FRemoteClientLatencyInfo Priority;
+    int64 OrdersSent = 0;
+    int64 OrdersCompleted = 0;
+
+    /** Completed orders per second, averaged since the last reset */
+    float OrdersPerSecond = 0.f;
+
+    /** Servo targets written by SendMovement */
+    int64 ServoWrites = 0;
+
+    /** Servo targets overwritten by a later SendMovement before they were sent */
+    int64 CoalescedWrites = 0;
+
+    /** Servo targets dropped because they were within the deadband of the last commanded position */
+    int64 DeadbandDrops = 0;
+    TMap<ECLIErrorCode, int64> NacksByCode;
+};
+
+enum class ERemoteClientPhase : uint8
+{
+	Queue,
+	ServerAck,
+	McuAck,
+	Order,
+	Connect,
+	SelectMCU,
+	MCUInfo,
+	Startup,
+	Priority,
+	Num
+};
+
+/**
+ * Lock-free latency histogram in microseconds, HDR style: exact below 16us, then 8 linear sub-buckets per power of 2
+ * (12.5% resolution) up to ~70 minutes. Any thread records with relaxed atomics, readers get approximate percentiles.
+ */
+class REMOTECLIENTCORE_API FLatencyHistogram
+{
+	public:
+
+		static constexpr uint32 SubBucketBits = 3;
+		static constexpr uint32 SubBuckets = 1<<SubBucketBits;
+		static constexpr uint32 NumBuckets = (32-SubBucketBits+1)*SubBuckets;
+
+		FLatencyHistogram(){ Reset(); }
+
+		void Record(uint64 Microseconds);
+		void Reset();
+		void GetInfo(FRemoteClientLatencyInfo& Out) const;
+
+		/** Upper bound of the bucket reaching the percentile (0-100), 0 if empty */
+		uint64 GetPercentileUs(double Percentile) const;
+
+	private:
+
+		std::atomic<uint32> buckets[NumBuckets];
+		std::atomic<uint64> count;
+		std::atomic<uint64> sumUs;
+		std::atomic<uint64> maxUs;
+
+		static uint32 _BucketOf(uint32 us);
+		static uint32 _UpperBoundOf(uint32 bucket);
+};
+
+/**
+ * Remote client instrumentation. Phases are timed with FPlatformTime::Cycles64 and recorded into histograms & counters,
+ * and every sample is also emitted on the "RemoteClient" Unreal Insights trace channel (-trace=RemoteClient).
+ */
+class REMOTECLIENTCORE_API FRemoteClientStats
+{
+	public:
+
+		FRemoteClientStats(){ Reset(); }
+
+		/* Any thread */
+		void RecordWrites(int32 Servos, int32 Coalesced);
+		void Reset();
+		void GetInfo(FRemoteClientStatsInfo& Out) const;
+		const FLatencyHistogram& GetPhase(ERemoteClientPhase Phase) const { return phases[(int32)Phase]; }
+		uint64 GetOrdersSent() const { return ordersSent.load(std::memory_order_relaxed); }
+		uint64 GetOrdersCompleted() const { return ordersCompleted.load(std::memory_order_relaxed); }
+
+		/* Connection thread, cycle timestamps (0 = unknown, the sample is skipped) */
+		void RecordPhase(ERemoteClientPhase Phase, uint64 StartCycles, uint64 EndCycles, uint16 Seq = 0);
+		void RecordOrderSent(uint16 Seq, uint64 QueuedCycles, uint64 SentCycles);
+		void RecordOrderCompleted(uint16 Seq, uint64 QueuedCycles, uint64 ServerAckCycles, uint64 McuAckCycles);
+		void RecordNack(uint8 Code);
+		void RecordInFlight(int32 Orders);
+		void RecordDeadbandDrops(int32 Servos);
+
+	private:
+
+		FLatencyHistogram phases[(int32)ERemoteClientPhase::Num];
+		std::atomic<uint64> ordersSent;
+		std::atomic<uint64> ordersCompleted;
+		std::atomic<uint64> servoWrites;
+		std::atomic<uint64> coalescedWrites;
+		std::atomic<uint64> deadbandDrops;
+		std::atomic<uint64> nacks[256];    /* By NACK code */
+		std::atomic<uint64> resetCycles;
+};
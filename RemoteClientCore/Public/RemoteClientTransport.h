@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FSocket;
+
+/**
+ * Byte stream carrying the protocol frames between the client and the server. Wrapped for Blueprints in RemoteClientTypes.h
+ */
+enum class ERemoteClientTransport : uint8
+{
+	Tcp				=0,
+	SharedMemory	=1
+};
+
+enum class ETransportConnectState : uint8
+{
+	Pending,
+	Connected,
+	Failed
+};
+
+/**
+ * Non-blocking byte stream to the server, owned & polled by one thread. Closed on destruction.
+ * Frames are carried as is, framing & decoding stay with the connection.
+ */
+class REMOTECLIENTCORE_API IRemoteClientTransport
+{
+	public:
+
+		virtual ~IRemoteClientTransport() = default;
+
+		/** Starts connecting to the server at Address:Port without blocking. Returns false if it was refused right away */
+		virtual bool Connect(const FString& Address, int32 Port) = 0;
+
+		/** Waits up to Wait for the connect in progress */
+		virtual ETransportConnectState PollConnect(FTimespan Wait) = 0;
+
+		/** Waits up to Wait for incoming bytes. True if there may be some to read (or the peer is gone) */
+		virtual bool WaitForRead(FTimespan Wait) = 0;
+
+		/** False once the connection failed. OutSent is below Len (down to 0) while the peer does not keep up */
+		virtual bool Send(const uint8* Data, int32 Len, int32& OutSent) = 0;
+
+		/** False once the connection failed. OutRead is 0 when there is nothing to read */
+		virtual bool Recv(uint8* Data, int32 MaxLen, int32& OutRead) = 0;
+
+		static TUniquePtr<IRemoteClientTransport> Create(ERemoteClientTransport Type);
+};
+
+/** TCP socket, Nagle off */
+class REMOTECLIENTCORE_API FTcpTransport final : public IRemoteClientTransport
+{
+	public:
+
+		FTcpTransport() = default;
+		/** Takes over a socket accepted by a server */
+		explicit FTcpTransport(FSocket* InAccepted);
+		virtual ~FTcpTransport();
+
+		virtual bool Connect(const FString& Address, int32 Port) override;
+		virtual ETransportConnectState PollConnect(FTimespan Wait) override;
+		virtual bool WaitForRead(FTimespan Wait) override;
+		virtual bool Send(const uint8* Data, int32 Len, int32& OutSent) override;
+		virtual bool Recv(uint8* Data, int32 MaxLen, int32& OutRead) override;
+
+	private:
+
+		FSocket* sck = nullptr;
+};
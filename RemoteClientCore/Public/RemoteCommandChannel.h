@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServoInfo.h"
+#include "CLIErrorCode.h"
+#include "ServoStateTable.h"
+
+class FServoPoseConverter;
+
+class FRemoteClientConnection;
+
+/**
+ * Movement handle of one MCU channel for C++ callers (animation, AI...), see URemoteMCUChannel::GetCommandChannel.
+ * Copyable & usable from any thread, it does not touch the UObject side and does not keep the connection alive:
+ * once the channel is closed every call is refused with NoServerConnection.
+ * Batches are validated at once against the servo count & the servo limits, see FRemoteClientConnection::SetServoLimits.
+ */
+class REMOTECLIENTCORE_API FRemoteCommandChannel
+{
+	public:
+
+		FRemoteCommandChannel() = default;
+		explicit FRemoteCommandChannel(const TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe>& InConnection) : connection(InConnection) {}
+
+		/** False once the channel it was taken from is closed */
+		bool IsValid() const { return connection.IsValid(); }
+
+		/** Queued into the pending movement table. False if refused, see GetErr */
+		bool Send(TArrayView<const FServoInfo> servoMovements) const;
+
+		/** Packed batch: servo i moves to positions[i] (0-179) for every bit i of mask */
+		bool Send(uint32 mask, const uint8 (&positions)[MAX_SERVOS]) const;
+
+		/**
+		 * Converts a joint angle pose (degrees) of the servos of mask with Converter & sends only the servos whose position
+		 * changed. True if nothing changed. On refusal Converter is invalidated, so the next pose goes out whole
+		 */
+		bool SendPose(FServoPoseConverter& Converter, const float (&AnglesDeg)[MAX_SERVOS], uint32 mask) const;
+
+		/* Fulfilled on the connection thread once the MCU applied the movement, no event is broadcast */
+		TFuture<ECLIErrorCode> SendAsync(TArrayView<const FServoInfo> servoMovements) const;
+		TFuture<ECLIErrorCode> SendAsync(uint32 mask, const uint8 (&positions)[MAX_SERVOS]) const;
+
+		ECLIErrorCode GetErr() const;
+
+		/** Lock-free, refreshes the caller's snapshot only if the positions changed */
+		bool ReadServoPositions(FServoPositionSnapshot& InOutSnapshot) const;
+
+	private:
+
+		TWeakPtr<FRemoteClientConnection, ESPMode::ThreadSafe> connection;
+};
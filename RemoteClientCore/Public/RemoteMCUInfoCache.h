@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServoStateTable.h"
+
+/**
+ * Last iMCU result & position limits (lMCU) of each MCU, persisted under Saved/RemoteClient/MCUInfo.
+ * A connection loads it on Connect and takes movements right away, its own iMCU & lMCU then revalidate the cached data.
+ */
+class REMOTECLIENTCORE_API FRemoteMCUInfoCache
+{
+	public:
+
+		/** Returns false if nothing valid is cached for MCU_Name. Positions are 1-180 */
+		static bool Load(const FString& MCU_Name, uint8 (&OutPositions)[MAX_SERVOS], uint8& OutCount);
+
+		/** Written on a background task, the caller is never held by the disk */
+		static void Save(const FString& MCU_Name, const uint8* Positions, uint8 Count);
+
+		/** Same for the limits of each servo, 1-180. Slots past OutCount are left untouched */
+		static bool LoadLimits(const FString& MCU_Name, uint8 (&OutMin)[MAX_SERVOS], uint8 (&OutMax)[MAX_SERVOS], uint8& OutCount);
+		static void SaveLimits(const FString& MCU_Name, const uint8* MinPositions, const uint8* MaxPositions, uint8 Count);
+
+	private:
+
+		static FString _Path(const FString& MCU_Name, const TCHAR* Extension);
+		static void _Write(const FString& Path, TArray<uint8>&& Data);
+};
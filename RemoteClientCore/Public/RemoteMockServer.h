@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "HAL/Runnable.h"
+#include "Math/RandomStream.h"
+#include "ServoStateTable.h"
+#include "RemoteClientProtocol.h"
+#include "RemoteClientTransport.h"
+
+class FSocket;
+class FRunnableThread;
+class FSharedMemoryListener;
+
+struct FRemoteMockServerSettings
+{
+	int32 Port = 54817;
+	uint8 ServoCount = 16;
+	float McuLatencyMs = 5.f;       /* Time the MCU takes to complete a movement order */
+	float McuJitterMs = 0.f;        /* Uniform +- jitter added to the latency */
+	float NackPercent = 0.f;        /* Orders refused with NACK_ErrorContactingMCU instead of the server ACK */
+	int32 SegmentBytes = 0;         /* >0: replies are sent in chunks of this size, to exercise partial reads */
+	bool bAllowBinary = true;       /* ACK the binary protocol offer, NACK it otherwise */
+	bool bSharedMemory = false;     /* Serve the shared memory channel of Port instead of TCP */
+	uint8 LimitMin = 1;             /* Position limits of every servo (1-180), answered to lMCU. Orders outside are NACKed */
+	uint8 LimitMax = 180;
+};
+
+/**
+ * Local stand-in for the robot server & MCU, development builds only.
+ * Speaks the client protocol on one TCP connection at a time: log-in, PROT, sMCU, iMCU, SRVP/SRVQ with the two-stage
+ * ACK (server ACK right away, MCU ACK once the simulated MCU completed the order, orders complete one after the other)
+ * the SRVU priority movement answered by UACK, the lMCU position limits, the RTMD/RTSP real time mode and TLMS/TLMD telemetry,
+ * in both text & binary framing.
+ */
+class REMOTECLIENTCORE_API FRemoteMockServer : public FRunnable
+{
+	public:
+
+		explicit FRemoteMockServer(const FRemoteMockServerSettings& InSettings);
+		virtual ~FRemoteMockServer();
+
+		/** Opens the listen socket & starts the server thread. Returns false if the port could not be bound */
+		bool Start();
+
+		const FRemoteMockServerSettings& GetSettings() const { return settings; }
+
+		/** Reads "Port= Servos= Latency= Jitter= Nack= Split= Binary= Shm= LimitMin= LimitMax=" console arguments over InOut */
+		static void ParseSettings(const TCHAR* Args, FRemoteMockServerSettings& InOut);
+
+		/* FRunnable */
+		virtual uint32 Run() override;
+		virtual void Stop() override;
+
+	private:
+
+		/* Movement order the simulated MCU is working on */
+		struct FMcuOrder
+		{
+			double due;
+			uint16 seq;
+			bool bSequenced;
+			bool bPriority;               /* SRVU, answered with UACK */
+			uint32 mask;
+			uint8 positions[MAX_SERVOS];
+		};
+
+		FRemoteMockServerSettings settings;
+		FRunnableThread* thread = nullptr;
+		std::atomic<bool> stopping = false;
+		FSocket* listenSck = nullptr;
+		TUniquePtr<FSharedMemoryListener> shmListener;
+
+		/* Server thread only */
+		TUniquePtr<IRemoteClientTransport> client;
+		TArray<uint8> inBuffer;
+		TArray<uint8> outBuffer;
+		EWireProtocol protocol = EWireProtocol::Text;
+		bool bMcuSelected = false;
+		bool bRealTime = false;
+		double mcuFreeAt = 0;
+		double telemetryPeriod = 0;       /* 0 = not subscribed */
+		double nextTelemetry = 0;
+		TArray<FMcuOrder> mcuOrders;      /* Completion order, due times never decrease. Priority orders first */
+		uint8 positions[MAX_SERVOS];
+		FRandomStream random;
+
+		void _Accept();
+		void _CloseClient();
+		bool _ReadClient();
+		void _CompleteDueOrders(double now);
+		bool _FlushClient();
+
+		int32 _NextTextFrame(int32 offset) const;
+		int32 _NextBinaryFrame(int32 offset) const;
+		void _HandleText(const uint8* frame, int32 len);
+		void _HandleBinary(const uint8* frame, int32 len);
+		void _HandleMovement(uint16 seq, bool bSequenced, uint32 mask, const uint8 (&targets)[MAX_SERVOS]);
+		void _HandlePriority(uint8 flags, uint32 mask, const uint8 (&targets)[MAX_SERVOS]);
+		bool _WithinLimits(uint32 mask, const uint8 (&targets)[MAX_SERVOS]) const;
+
+		void _SendAck(uint16 seq, uint8 stage, uint8 code);
+		void _SendNack(uint16 seq, uint8 code);
+		void _SendPriorityAck(uint8 code);
+		void _SendInfo();
+		void _SendLimits();
+		void _SendServoFrame(uint8 binaryType, const char* textType);
+		void _SubscribeTelemetry(uint16 rateHz);
+};
+
+#endif // !UE_BUILD_SHIPPING
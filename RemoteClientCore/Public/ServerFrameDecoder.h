@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EFrameDecodeResult : uint8
+{
+	Frame,		/* A complete frame was returned */
+	Incomplete,	/* More data has to be received */
+	Corrupt		/* Garbage was skipped while looking for the next frame header */
+};
+
+/**
+ * Incremental decoder for the "!s-" ... "-e!" frames sent by the server (or length-prefixed binary frames once negotiated).
+ * Received bytes are written straight into a persistent ring buffer, complete frames are handed out as views
+ * over that buffer, so partial reads and several frames per read are both handled without allocating.
+ */
+class REMOTECLIENTCORE_API FServerFrameDecoder
+{
+	public:
+
+		static constexpr uint32 Capacity = 4096; /* Must be a power of 2 */
+		static constexpr uint32 MaxFrameLen = 1024;
+
+		/** Drops every buffered byte and returns to text framing, used when a new connection is opened */
+		void Reset();
+
+		/** Switches to the length-prefixed binary framing (see FRemoteClientProtocol), applies from the next frame on */
+		void SetBinaryFraming(bool bBinary){ binaryFraming=bBinary; }
+
+		/** Contiguous free region where the next Recv can write. Views returned by Next() are invalidated by the write */
+		uint8* GetWriteBuffer(int32& OutSize);
+		void CommitWrite(int32 BytesWritten);
+
+		/** Extracts the next complete frame. The view stays valid until the next write into the decoder */
+		EFrameDecodeResult Next(TArrayView<const uint8>& OutFrame);
+
+		int32 Num() const { return (int32)(Tail-Head); }
+
+	private:
+
+		uint8 Ring[Capacity];
+		uint8 Scratch[MaxFrameLen]; /* Frames wrapping around the end of the ring are linearized here */
+		uint32 Head=0;              /* Read & write positions, only wrapped when indexing */
+		uint32 Tail=0;
+		bool binaryFraming=false;
+
+		uint8 _At(uint32 i) const { return Ring[(Head+i)&(Capacity-1)]; }
+		bool _IsHeaderAt(uint32 i) const;
+		uint32 _MinFrameLen() const;
+		EFrameDecodeResult _NextBinary(TArrayView<const uint8>& OutFrame);
+		void _Emit(uint32 len, TArrayView<const uint8>& OutFrame);
+};
@@ -3,22 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "ServoInfo.generated.h"
 
 /**
- * Struct used to store the information pair (servo id,servo position)
+ * Struct used to store the information pair (servo id,servo position). Wrapped for Blueprints in RemoteClientTypes.h
  */
-USTRUCT(BlueprintType)
 struct FServoInfo
 {
-    GENERATED_BODY()
-
-public:
-
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Information Struct", meta=(ClampMin=0, ClampMax=31))
     uint8 servoID;
-
-    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Information Struct", meta=(ClampMin=0, ClampMax=179))
     uint8 servoPosition;
 
     FServoInfo(): servoID(0), servoPosition(0){}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServoStateTable.h"
+
+/**
+ * Byte-lane operations over the 32 servo slots, 8 slots per 64-bit word (SWAR): a whole servo table is handled in
+ * 4 steps with no branch per servo, on any target. Lane i is servo i, results come back as 32-bit servo masks.
+ */
+namespace ServoLanes
+{
+	constexpr int32 WORDS = MAX_SERVOS/8;
+	constexpr uint64 HIGH_BITS = 0x8080808080808080ull;
+	constexpr uint64 ONES = 0x0101010101010101ull;
+
+	static_assert(MAX_SERVOS%8==0, "Whole words of lanes");
+	static_assert(PLATFORM_LITTLE_ENDIAN, "Lane i is byte i of the words");
+
+	FORCEINLINE uint64 Load(const uint8* Lanes){ uint64 w; FMemory::Memcpy(&w, Lanes, 8); return w; }
+	FORCEINLINE void Store(uint8* Lanes, uint64 W){ FMemory::Memcpy(Lanes, &W, 8); }
+
+	/** High bit of each lane set where a >= b (unsigned) */
+	FORCEINLINE uint64 GreaterOrEqual(uint64 A, uint64 B){
+		/* Low 7 bits compared with the high bit as a borrow guard, then the high bits decide where they differ */
+		const uint64 low=(A|HIGH_BITS)-(B&~HIGH_BITS);
+		return ((A&~B)|(~(A^B)&low))&HIGH_BITS;
+	}
+
+	/** High bit of each lane set where a != b */
+	FORCEINLINE uint64 NotEqual(uint64 A, uint64 B){
+		/* A lane is non zero if its low 7 bits carry into the high bit, or if the high bit is already set */
+		const uint64 x=A^B;
+		return (((x&~HIGH_BITS)+~HIGH_BITS)|x)&HIGH_BITS;
+	}
+
+	/** Lane high bits widened to whole lanes (0x00 or 0xFF) */
+	FORCEINLINE uint64 WidenHighBits(uint64 W){
+		return ((W&HIGH_BITS)>>7)*0xFF;
+	}
+
+	/** A where the lane of Mask is 0xFF, B elsewhere */
+	FORCEINLINE uint64 Select(uint64 A, uint64 B, uint64 Mask){
+		return (A&Mask)|(B&~Mask);
+	}
+
+	FORCEINLINE uint64 Max(uint64 A, uint64 B){ return Select(A, B, WidenHighBits(GreaterOrEqual(A, B))); }
+	FORCEINLINE uint64 Min(uint64 A, uint64 B){ return Select(B, A, WidenHighBits(GreaterOrEqual(A, B))); }
+
+	/** The 8 lane high bits as an 8-bit mask, lane 0 in bit 0 */
+	FORCEINLINE uint32 HighBitsToMask(uint64 W){
+		return (uint32)(((W&HIGH_BITS)*0x0002040810204081ull)>>56);
+	}
+
+	/** Adds Value (< 128) to every lane, without carry between lanes */
+	FORCEINLINE uint64 AddEach(uint64 W, uint8 Value){
+		return ((W&~HIGH_BITS)+ONES*Value)^(W&HIGH_BITS);
+	}
+
+	/** Out[i] = In[i] + Value for the 32 lanes */
+	FORCEINLINE void AddEach(const uint8 (&In)[MAX_SERVOS], uint8 Value, uint8 (&Out)[MAX_SERVOS]){
+		for(int32 w=0; w<WORDS; w++){
+			Store(Out+8*w, AddEach(Load(In+8*w), Value));
+		}
+	}
+
+	/** Lanes where A[i] != B[i], as a servo mask */
+	FORCEINLINE uint32 Differ(const uint8 (&A)[MAX_SERVOS], const uint8 (&B)[MAX_SERVOS]){
+		uint32 differ=0;
+		for(int32 w=0; w<WORDS; w++){
+			differ|=HighBitsToMask(NotEqual(Load(A+8*w), Load(B+8*w)))<<(8*w);
+		}
+		return differ;
+	}
+
+	/** Lanes where Min[i] <= Values[i] <= Max[i] does not hold, as a servo mask. Min & Max are given as words */
+	FORCEINLINE uint32 OutOfRange(const uint8 (&Values)[MAX_SERVOS], const uint64 (&Min)[WORDS], const uint64 (&Max)[WORDS]){
+		uint32 outside=0;
+		for(int32 w=0; w<WORDS; w++){
+			const uint64 v=Load(Values+8*w);
+			const uint64 inside=GreaterOrEqual(v, Min[w])&GreaterOrEqual(Max[w], v);
+			outside|=(~HighBitsToMask(inside)&0xFF)<<(8*w);
+		}
+		return outside;
+	}
+
+	/** Out[i] = Values[i] clamped to [Min[i], Max[i]]. Min & Max are given as words */
+	FORCEINLINE void Clamp(const uint8 (&Values)[MAX_SERVOS], const uint64 (&Min)[WORDS], const uint64 (&Max)[WORDS], uint8 (&Out)[MAX_SERVOS]){
+		for(int32 w=0; w<WORDS; w++){
+			Store(Out+8*w, ServoLanes::Min(ServoLanes::Max(Load(Values+8*w), Min[w]), Max[w]));
+		}
+	}
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServoStateTable.h"
+
+/**
+ * Joint angle -> servo position mapping of one servo: position = offset + scale * (bInvert ? -angle : angle), in degrees,
+ * clamped to [minPosition, maxPosition] (0-179). Wrapped for Blueprints in RemoteClientTypes.h
+ */
+struct FServoCalibration
+{
+    float offset = 0.f;
+    float scale = 1.f;
+    bool bInvert = false;
+    uint8 minPosition = 0;
+    uint8 maxPosition = 179;
+};
+
+/**
+ * Converts a joint angle pose (degrees, one per servo) to wire positions (1-180) in one pass, 4 servos per SIMD step,
+ * and reports the servos whose position changed since the previous pose. Allocation free & lock free; not thread safe,
+ * each producer thread owns its converter (it is a plain copyable value, see FRemoteCommandChannel::SendPose).
+ */
+class REMOTECLIENTCORE_API FServoPoseConverter
+{
+	public:
+
+		FServoPoseConverter();
+
+		void SetCalibration(int32 ServoID, const FServoCalibration& Calibration);
+		const FServoCalibration& GetCalibration(int32 ServoID) const { return calibrations[ServoID]; }
+
+		/**
+		 * Converts the angles of the servos of Mask, the other angles are ignored (finite values only).
+		 * OutWire holds the wire positions of Mask. Returns the servos of Mask whose wire position changed
+		 */
+		uint32 Convert(const float (&AnglesDeg)[MAX_SERVOS], uint32 Mask, uint8 (&OutWire)[MAX_SERVOS]);
+
+		/** The next Convert reports every servo of its mask, e.g. after the converted pose could not be sent */
+		void Invalidate(){ lastMask=0; }
+
+	private:
+
+		FServoCalibration calibrations[MAX_SERVOS];
+
+		/* Calibration in lane form, wire units */
+		alignas(16) float gain[MAX_SERVOS];
+		alignas(16) float bias[MAX_SERVOS];
+		alignas(16) float lower[MAX_SERVOS];
+		alignas(16) float upper[MAX_SERVOS];
+
+		uint8 last[MAX_SERVOS];
+		uint32 lastMask = 0;    /* Servos with a position in last */
+};
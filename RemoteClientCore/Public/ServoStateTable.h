@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Servo ids are 0-31 (see FServoInfo), so every per-servo table is a fixed 32 slot array */
+constexpr int32 MAX_SERVOS = 32;
+
+/** How targets outside a servo's limits are handled before anything goes on the wire. Wrapped for Blueprints in RemoteClientTypes.h */
+enum class ERemoteClientLimitMode : uint8
+{
+	Reject		=0,		/* The batch is refused with INVALID_SERVO_POSITION, like the server would NACK it */
+	Clamp		=1,		/* Targets are clamped to the limits & sent */
+	Off			=2		/* Only the 0-179 range is checked, the MCU limits are not retrieved */
+};
+
+/** Consistent copy of the current servo positions, reused by the caller between reads */
+struct FServoPositionSnapshot
+{
+	uint64 version = 0;             /* Increases every time the positions change, 0 = never read */
+	uint8 servoCount = 0;
+	uint8 positions[MAX_SERVOS];    /* 1-180, only the first servoCount are valid */
+};
+
+/**
+ * Servo tables shared between the callers and the connection thread, fixed size and lock-free.
+ * Pending targets are stored per slot and flagged in a 32-bit dirty mask: concurrent writers coalesce into the same
+ * slots and the sender takes everything flagged with a single exchange. Positions keep the +1 wire offset (1-180).
+ * Current positions are only written by the connection thread and published under a seqlock, readers never block it.
+ */
+class REMOTECLIENTCORE_API FServoStateTable
+{
+	public:
+
+		FServoStateTable();
+
+		uint8 GetServoCount() const { return servoCount.load(std::memory_order_acquire); }
+
+		/** Any thread. Stores the targets in their slots, then publishes them in the dirty mask. Returns the slots that were still pending */
+		uint32 SetPending(const uint8* positions, uint32 mask);
+		bool HasPending() const { return dirtyMask.load(std::memory_order_acquire)!=0; }
+		/** Time of the first write since the last take (FPlatformTime::Cycles64), 0 if none */
+		uint64 GetPendingSinceCycles() const { return pendingSince.load(std::memory_order_relaxed); }
+
+		/**
+		 * Connection thread. Takes every flagged slot, OutPositions[i] is only written where bit i is set.
+		 * OutSinceCycles is the time of the oldest write taken (FPlatformTime::Cycles64), 0 if unknown.
+		 */
+		uint32 TakePending(uint8 (&OutPositions)[MAX_SERVOS], uint64& OutSinceCycles);
+
+		/** Connection thread. Applies the positions flagged in mask once the MCU completed them */
+		void CommitPositions(const uint8 (&positions)[MAX_SERVOS], uint32 mask);
+
+		/** Connection thread. Applies measured positions (telemetry), the version only moves if one changed. Returns the servos that moved */
+		uint32 UpdatePositions(const uint8* positions, uint8 count);
+
+		/** Connection thread. Resets the table for a freshly retrieved MCU (iMCU), drops pending targets */
+		void Reset(const uint8* positions, uint8 count);
+
+		/**
+		 * Any thread. Range each servo's targets (1-180) must stay in, the full range until set.
+		 * The limits applied are the intersection of these (set by the user) & the MCU limits (reported by the server)
+		 */
+		void SetLimits(const uint8 (&MinPositions)[MAX_SERVOS], const uint8 (&MaxPositions)[MAX_SERVOS]);
+		void SetMCULimits(const uint8 (&MinPositions)[MAX_SERVOS], const uint8 (&MaxPositions)[MAX_SERVOS]);
+		void ResetMCULimits();
+
+		/** Any thread. False while only the full range stands in for the MCU limits (not retrieved, or lMCU unsupported) */
+		bool HasMCULimits() const { return mcuLimitsSet.load(std::memory_order_relaxed); }
+
+		/** Any thread, lock-free. Servos of mask whose target (1-180) is outside its limits, all checked at once */
+		uint32 FindOutOfLimits(const uint8 (&positions)[MAX_SERVOS], uint32 mask) const;
+
+		/** Any thread, lock-free. Servos of mask whose target is outside the wire range (1-180), whatever the limits */
+		static uint32 FindOutOfRange(const uint8 (&positions)[MAX_SERVOS], uint32 mask);
+
+		/** Any thread, lock-free. Every target (1-180) clamped to its servo's limits, Positions & OutPositions may be the same array */
+		void ClampToLimits(const uint8 (&positions)[MAX_SERVOS], uint8 (&OutPositions)[MAX_SERVOS]) const;
+
+		/** Any thread. Limits applied, 1-180 */
+		void GetLimits(uint8 (&OutMin)[MAX_SERVOS], uint8 (&OutMax)[MAX_SERVOS]) const;
+
+		/** Any thread, lock-free & allocation free. Refreshes the snapshot if the positions changed since it was taken */
+		bool ReadSnapshot(FServoPositionSnapshot& InOutSnapshot) const;
+		uint64 GetVersion() const { return sequence.load(std::memory_order_acquire)>>1; }
+
+	private:
+
+		std::atomic<uint8> servoCount;
+		std::atomic<uint32> dirtyMask;
+		std::atomic<uint64> pendingSince; /* Time of the first write since the last take, 0 = none */
+		std::atomic<uint8> pendingSlots[MAX_SERVOS];
+		std::atomic<uint8> currentSlots[MAX_SERVOS];
+		std::atomic<uint64> sequence;   /* Odd while the connection thread writes current positions, version = sequence/2 */
+		std::atomic<uint64> limitMin[MAX_SERVOS/8];    /* 8 servos per word, see ServoLanes */
+		std::atomic<uint64> limitMax[MAX_SERVOS/8];
+		std::atomic<uint64> mcuMin[MAX_SERVOS/8];
+		std::atomic<uint64> mcuMax[MAX_SERVOS/8];
+		std::atomic<bool> mcuLimitsSet;
+
+		void _LoadLimits(uint64 (&OutMin)[MAX_SERVOS/8], uint64 (&OutMax)[MAX_SERVOS/8]) const;
+
+		void _BeginWrite();
+		void _EndWrite();
+};
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServoStateTable.h"
+
+/**
+ * Interpolation between the keyframes of a servo trajectory. Wrapped for Blueprints in RemoteClientTypes.h
+ */
+enum class ETrajectoryInterpolation : uint8
+{
+	Linear		=0,
+	Cubic		=1
+};
+
+/**
+ * Time-stamped target of one servo, time in seconds from the start of the trajectory batch. Wrapped for Blueprints in RemoteClientTypes.h
+ */
+struct FServoKeyframe
+{
+    float time;
+    uint8 servoID;
+    uint8 servoPosition;
+
+    FServoKeyframe(): time(0), servoID(0), servoPosition(0){}
+
+    FServoKeyframe(float t, uint8 id, uint8 pos){
+        time = FMath::Max(t, 0.f);
+        servoID = FMath::Clamp<uint8>(id, 0, 31);
+        servoPosition = FMath::Clamp<uint8>(pos, 0, 179);
+    }
+};
+
+/**
+ * Plays keyframed servo trajectories, connection thread only.
+ * Each servo has its own track, sampled at the control rate and quantized to wire positions (1-180). Only the servos whose
+ * quantized position changed since the last sample are emitted, so a whole gesture turns into coalesced movement frames.
+ */
+class REMOTECLIENTCORE_API FTrajectoryScheduler
+{
+	public:
+
+		/**
+		 * Loads a batch of keyframes, times relative to Now (or to the end of the playing trajectory when appending).
+		 * Tracks start from the servo's current value: the playing track value if any, StartPositions (1-180) otherwise.
+		 */
+		void Load(TArrayView<const FServoKeyframe> Keyframes, ETrajectoryInterpolation Interpolation, bool bAppend, double Now,
+			const uint8 (&StartPositions)[MAX_SERVOS]);
+
+		/** Samples every track at Now. Returns the servos whose position changed, OutPositions is only written where set */
+		uint32 Sample(double Now, uint8 (&OutPositions)[MAX_SERVOS]);
+
+		void Clear();
+		bool IsActive() const { return activeMask!=0; }
+
+	private:
+
+		struct FKey
+		{
+			double time;
+			float position;     /* Wire position, 1-180 */
+		};
+
+		struct FTrack
+		{
+			TArray<FKey> keys;
+			ETrajectoryInterpolation interpolation = ETrajectoryInterpolation::Linear;
+			int32 segment = 0;  /* Last segment sampled, time only moves forward */
+			uint8 lastSent = 0;
+		};
+
+		FTrack tracks[MAX_SERVOS];
+		uint32 activeMask = 0;
+
+		static float _Evaluate(FTrack& track, double time);
+};
@@ -0,0 +1,14 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+/* Protocol core of the remote client: connection, framing, servo state & mock server. Core only, no UObject */
+public class RemoteClientCore: ModuleRules
+{
+	public RemoteClientCore(ReadOnlyTargetRules Target): base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core", "Sockets", "Networking" });
+	}
+}
@@ -0,0 +1,115 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteClientTypes.h"
+
+/* The enums are converted with a cast, their values must match */
+#define REMOTECLIENT_CHECK_ENUM(Enum, Name) static_assert((uint8)Enum::Name==(uint8)Enum##BP::Name, #Enum "BP::" #Name " differs from " #Enum "::" #Name)
+
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, CLEAR);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, GenericError);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, ServerConnError);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, CorruptedICMU);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NoServerConnection);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, ConnectTimeout);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, ServerTimeout);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, MCUTimeout);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, StaleMCUInfo);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, Preempted);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, PriorityTimeout);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, INVALID_SERVO_ID);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, INVALID_SERVO_POSITION);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_InvalidQuery);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_NoActiveMCU);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_OnRTMode);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_InvalidParameter);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_ServoCountMismatch);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_NoMCUInfo);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_MCUOffline);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_ErrorContactingMCU);
+REMOTECLIENT_CHECK_ENUM(ECLIErrorCode, NACK_ErrorLoadingMINMAX);
+
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, IDLE);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, WAITING_SERVER_ACK);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, WAITING_MCU_ACK);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, STREAMING);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, SWITCHING_RT_MODE);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, SWITCHING_TELEMETRY);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, RETRIEVING_LIMITS);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, CONNECTING);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, NEGOTIATING_PROTOCOL);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, NO_SERVER_CONN);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, RETRIEVING_INFO);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, RETRIEVING_INFO_sMCU);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, ON_MCU_SELECT);
+REMOTECLIENT_CHECK_ENUM(ECLIStatusCode, STARTING_UP);
+
+REMOTECLIENT_CHECK_ENUM(ERemoteClientTransport, Tcp);
+REMOTECLIENT_CHECK_ENUM(ERemoteClientTransport, SharedMemory);
+
+REMOTECLIENT_CHECK_ENUM(ERemoteClientLimitMode, Reject);
+REMOTECLIENT_CHECK_ENUM(ERemoteClientLimitMode, Clamp);
+REMOTECLIENT_CHECK_ENUM(ERemoteClientLimitMode, Off);
+
+REMOTECLIENT_CHECK_ENUM(ETrajectoryInterpolation, Linear);
+REMOTECLIENT_CHECK_ENUM(ETrajectoryInterpolation, Cubic);
+
+#undef REMOTECLIENT_CHECK_ENUM
+
+FRemoteClientStatsInfoBP::FRemoteClientStatsInfoBP(const FRemoteClientStatsInfo& Info):
+    Queue(Info.Queue), ServerAck(Info.ServerAck), McuAck(Info.McuAck), Order(Info.Order), Connect(Info.Connect),
+    SelectMCU(Info.SelectMCU), MCUInfo(Info.MCUInfo), Startup(Info.Startup), Priority(Info.Priority),
+    OrdersSent(Info.OrdersSent), OrdersCompleted(Info.OrdersCompleted), OrdersPerSecond(Info.OrdersPerSecond),
+    ServoWrites(Info.ServoWrites), CoalescedWrites(Info.CoalescedWrites), DeadbandDrops(Info.DeadbandDrops){
+
+    NacksByCode.Reserve(Info.NacksByCode.Num());
+    for(const auto& it : Info.NacksByCode){
+        NacksByCode.Add(RemoteClientBP::FromCore(it.Key), it.Value);
+    }
+}
+
+FServoCalibration FServoCalibrationBP::ToCore() const{
+    FServoCalibration calibration;
+    calibration.offset=offset;
+    calibration.scale=scale;
+    calibration.bInvert=bInvert;
+    calibration.minPosition=minPosition;
+    calibration.maxPosition=maxPosition;
+    return calibration;
+}
+
+namespace RemoteClientBP
+{
+    ECLIErrorCodeBP FromCore(ECLIErrorCode Code){
+        return (ECLIErrorCodeBP)Code;
+    }
+
+    ECLIStatusCodeBP FromCore(ECLIStatusCode Code){
+        return (ECLIStatusCodeBP)Code;
+    }
+
+    ERemoteClientTransport ToCore(ERemoteClientTransportBP Transport){
+        return (ERemoteClientTransport)Transport;
+    }
+
+    ERemoteClientLimitMode ToCore(ERemoteClientLimitModeBP LimitMode){
+        return (ERemoteClientLimitMode)LimitMode;
+    }
+
+    ETrajectoryInterpolation ToCore(ETrajectoryInterpolationBP Interpolation){
+        return (ETrajectoryInterpolation)Interpolation;
+    }
+
+    void ToCore(TArrayView<const FServoInfoBP> Servos, TArray<FServoInfo>& Out){
+        Out.Reset(Servos.Num());
+        for(const FServoInfoBP& servo : Servos){
+            Out.Add(servo.ToCore());
+        }
+    }
+
+    void ToCore(TArrayView<const FServoKeyframeBP> Keyframes, TArray<FServoKeyframe>& Out){
+        Out.Reset(Keyframes.Num());
+        for(const FServoKeyframeBP& keyframe : Keyframes){
+            Out.Add(keyframe.ToCore());
+        }
+    }
+}
@@ -0,0 +1,327 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RemoteMCUChannel.h"
+#include "RemoteClientCore.h"
+#include "Async/Async.h"
+#include "Misc/Paths.h"
+
+TFuture<ECLIErrorCode> URemoteMCUChannel::_Notify(TFuture<ECLIErrorCode>&& Result, FRemoteClientResultDelegate URemoteMCUChannel::* Event){
+
+    /* Fulfilled on the connection thread, the channel may be gone by the time the game thread runs the broadcast */
+    TWeakObjectPtr<URemoteMCUChannel> weakThis(this);
+    return Result.Next([weakThis, Event](ECLIErrorCode code){
+        AsyncTask(ENamedThreads::GameThread, [weakThis, Event, code](){
+            if(URemoteMCUChannel* channel=weakThis.Get()){
+                (channel->*Event).Broadcast(RemoteClientBP::FromCore(code));
+            }
+        });
+        return code;
+    });
+}
+
+TFuture<ECLIErrorCode> URemoteMCUChannel::Connect(const FRemoteClientSettings& Settings){
+    settings=Settings;
+    if(!connection){
+        /* Telemetry moves are taken on the game thread, the connection only asks again once they were */
+        TWeakObjectPtr<URemoteMCUChannel> weakThis(this);
+        connection = MakeShared<FRemoteClientConnection, ESPMode::ThreadSafe>([weakThis](){
+            AsyncTask(ENamedThreads::GameThread, [weakThis](){
+                if(URemoteMCUChannel* channel=weakThis.Get()){
+                    channel->_BroadcastMovedServos();
+                }
+            });
+        });
+        if(recorder){
+            connection->SetRecorder(recorder);
+        }
+    }
+    return _Notify(connection->Connect(settings), &URemoteMCUChannel::OnConnected);
+}
+
+/** Stops the connection thread, which closes the socket on its way out (after the last command channel call in progress) */
+void URemoteMCUChannel::Close(){
+    replayer.Reset();
+    connection.Reset();
+    recorder.Reset();
+}
+
+void URemoteMCUChannel::BeginDestroy(){
+    Close();
+    Super::BeginDestroy();
+}
+
+TFuture<ECLIErrorCode> URemoteMCUChannel::SelectMCU(const FString& MCU_Name){
+    if(!connection){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::NoServerConnection).GetFuture();
+    }
+    settings.mcuName=MCU_Name;
+    return _Notify(connection->SelectMCU(MCU_Name), &URemoteMCUChannel::OnMCUSelected);
+}
+
+void URemoteMCUChannel::Reconnect(){
+    Connect(settings);
+}
+
+/** Closes the connection once the query in progress (if any) has been answered */
+void URemoteMCUChannel::Disconnect(){
+    if(connection){
+        connection->Disconnect();
+    }
+}
+
+void URemoteMCUChannel::RetrieveMCUInfo(){
+    RetrieveMCUInfoAsync();
+}
+
+TFuture<ECLIErrorCode> URemoteMCUChannel::RetrieveMCUInfoAsync(){
+    if(!connection){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::NoServerConnection).GetFuture();
+    }
+    return _Notify(connection->RetrieveMCUInfo(), &URemoteMCUChannel::OnMCUInfoRetrieved);
+}
+
+/** For BP use, servo positions in the range 0-179 */
+TArray<FServoInfoBP> URemoteMCUChannel::GetCurrentServoPositions(){
+
+    TArray<FServoInfoBP> inf;
+    int64 version=0;
+    UpdateCurrentServoPositions(inf, version);
+    return inf;
+}
+
+bool URemoteMCUChannel::UpdateCurrentServoPositions(TArray<FServoInfoBP>& Positions, int64& Version){
+
+    FServoPositionSnapshot snapshot;
+    snapshot.version=(uint64)Version;
+    if(!ReadServoPositions(snapshot)){
+        return false;
+    }
+
+    Positions.Reset(); /* Keeps the allocation */
+    for(auto i=0; i<snapshot.servoCount; i++){
+        Positions.Add(FServoInfoBP(FServoInfo(i,snapshot.positions[i]-1))); /* Remove the +1 offset */
+    }
+    Version=(int64)snapshot.version;
+    return true;
+}
+
+bool URemoteMCUChannel::ReadServoPositions(FServoPositionSnapshot& InOutSnapshot) const{
+    return connection && connection->ReadServoPositions(InOutSnapshot);
+}
+
+int32 URemoteMCUChannel::ReadServoPositions(TArrayView<uint8> OutPositions, uint64& InOutVersion) const{
+
+    FServoPositionSnapshot snapshot;
+    snapshot.version=InOutVersion;
+    if(!ReadServoPositions(snapshot)){
+        return -1;
+    }
+
+    const int32 count=FMath::Min<int32>(snapshot.servoCount, OutPositions.Num());
+    FMemory::Memcpy(OutPositions.GetData(), snapshot.positions, count);
+    InOutVersion=snapshot.version;
+    return count;
+}
+
+void URemoteMCUChannel::SendMovement(const TArray<FServoInfoBP>& servoMovements){
+    RemoteClientBP::ToCore(servoMovements, coreServos);
+    if(OnMovementCompleted.IsBound()){
+        SendMovementAsync(coreServos);
+    }else if(connection){
+        /* Nobody listens, keep the allocation free path */
+        connection->SendMovement(coreServos);
+    }
+}
+
+bool URemoteMCUChannel::GetServoLimits(int32 ServoID, int32& OutMin, int32& OutMax) const{
+    if(!connection || ServoID<0 || ServoID>=MAX_SERVOS){
+        return false;
+    }
+    uint8 mins[MAX_SERVOS];
+    uint8 maxs[MAX_SERVOS];
+    connection->GetServoLimits(mins, maxs);
+    OutMin=mins[ServoID];
+    OutMax=maxs[ServoID];
+    return true;
+}
+
+bool URemoteMCUChannel::HasMCULimits() const{
+    return connection && connection->HasMCULimits();
+}
+
+void URemoteMCUChannel::SetServoCalibration(int32 ServoID, const FServoCalibrationBP& Calibration){
+    if(ServoID<0 || ServoID>=MAX_SERVOS){
+        UE_LOG(LogRemoteClientSystem, Warning, TEXT("SetServoCalibration: invalid servo %d"), ServoID);
+        return;
+    }
+    poseConverter.SetCalibration(ServoID, Calibration.ToCore());
+}
+
+void URemoteMCUChannel::SendPose(const TArray<float>& JointAnglesDeg){
+    float angles[MAX_SERVOS]={};
+    const int32 count=FMath::Min<int32>(JointAnglesDeg.Num(), MAX_SERVOS);
+    FMemory::Memcpy(angles, JointAnglesDeg.GetData(), count*sizeof(float));
+    GetCommandChannel().SendPose(poseConverter, angles, count<MAX_SERVOS ? (1u<<count)-1 : ~0u);
+}
+
+TFuture<ECLIErrorCode> URemoteMCUChannel::SendMovementAsync(TArrayView<const FServoInfo> servoMovements){
+    if(!connection){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::NoServerConnection).GetFuture();
+    }
+    return _Notify(connection->SendMovementAsync(servoMovements), &URemoteMCUChannel::OnMovementCompleted);
+}
+
+void URemoteMCUChannel::SendPriorityMovement(const TArray<FServoInfoBP>& servoMovements, bool bCancelPending){
+    RemoteClientBP::ToCore(servoMovements, coreServos);
+    SendPriorityMovementAsync(coreServos, bCancelPending);
+}
+
+TFuture<ECLIErrorCode> URemoteMCUChannel::SendPriorityMovementAsync(TArrayView<const FServoInfo> servoMovements, bool bCancelPending){
+    if(!connection){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::NoServerConnection).GetFuture();
+    }
+    return _Notify(connection->SendPriorityMovement(servoMovements, bCancelPending), &URemoteMCUChannel::OnPriorityMovementCompleted);
+}
+
+void URemoteMCUChannel::HoldPosition(){
+    HoldPositionAsync();
+}
+
+TFuture<ECLIErrorCode> URemoteMCUChannel::HoldPositionAsync(){
+    if(!connection){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::NoServerConnection).GetFuture();
+    }
+    return _Notify(connection->HoldPosition(), &URemoteMCUChannel::OnPriorityMovementCompleted);
+}
+
+void URemoteMCUChannel::PlayTrajectory(const TArray<FServoKeyframeBP>& Keyframes, ETrajectoryInterpolationBP Interpolation, bool bAppend){
+    if(connection){
+        TArray<FServoKeyframe> keyframes;
+        RemoteClientBP::ToCore(Keyframes, keyframes);
+        connection->PlayTrajectory(keyframes, RemoteClientBP::ToCore(Interpolation), bAppend, TrajectoryRateHz);
+    }
+}
+
+void URemoteMCUChannel::StopTrajectory(){
+    if(connection){
+        connection->StopTrajectory();
+    }
+}
+
+bool URemoteMCUChannel::IsTrajectoryPlaying(){
+    return connection && connection->IsTrajectoryPlaying();
+}
+
+void URemoteMCUChannel::SubscribeTelemetry(float RateHz){
+    SubscribeTelemetryAsync(RateHz);
+}
+
+TFuture<ECLIErrorCode> URemoteMCUChannel::SubscribeTelemetryAsync(float RateHz){
+    if(!connection){
+        return MakeFulfilledPromise<ECLIErrorCode>(ECLIErrorCode::NoServerConnection).GetFuture();
+    }
+    return _Notify(connection->SubscribeTelemetry(RateHz), &URemoteMCUChannel::OnTelemetrySubscribed);
+}
+
+void URemoteMCUChannel::_BroadcastMovedServos(){
+
+    if(!connection){
+        return;
+    }
+    const uint32 moved=connection->TakeMovedServos();
+    FServoPositionSnapshot snapshot;
+    if(moved==0 || !connection->ReadServoPositions(snapshot)){
+        return;
+    }
+
+    movedServos.Reset(); /* Keeps the allocation */
+    for(uint32 bits=moved; bits; bits&=bits-1){
+        const uint32 i=FMath::CountTrailingZeros(bits);
+        if(i<snapshot.servoCount){
+            movedServos.Add(FServoInfoBP(FServoInfo(i, snapshot.positions[i]-1))); /* Remove the +1 offset */
+        }
+    }
+    OnServoPositionsChanged.Broadcast(movedServos);
+}
+
+FString URemoteMCUChannel::_LogPath(const FString& FilePath){
+    return FPaths::IsRelative(FilePath) ? FPaths::ProjectSavedDir()/TEXT("RemoteClient")/FilePath : FilePath;
+}
+
+bool URemoteMCUChannel::StartRecording(const FString& FilePath){
+    StopRecording();
+    TSharedPtr<FRemoteClientRecorder, ESPMode::ThreadSafe> newRecorder=MakeShared<FRemoteClientRecorder, ESPMode::ThreadSafe>(_LogPath(FilePath));
+    if(!newRecorder->Start()){
+        return false;
+    }
+    recorder=newRecorder;
+    if(connection){
+        connection->SetRecorder(recorder);
+    }
+    return true;
+}
+
+/** The log is complete once the connection thread dropped the recorder */
+void URemoteMCUChannel::StopRecording(){
+    if(recorder && connection){
+        connection->SetRecorder(nullptr);
+    }
+    recorder.Reset();
+}
+
+bool URemoteMCUChannel::StartReplay(const FString& FilePath, float Speed){
+    StopReplay();
+    if(!connection){
+        return false;
+    }
+    replayer=MakeUnique<FRemoteClientReplayer>(*connection);
+    if(!replayer->Start(_LogPath(FilePath), Speed)){
+        replayer.Reset();
+        return false;
+    }
+    return true;
+}
+
+void URemoteMCUChannel::StopReplay(){
+    replayer.Reset(); /* Stops & joins the replay thread */
+}
+
+void URemoteMCUChannel::StartStreaming(bool bUseUDP){
+    if(connection){
+        connection->StartStreaming(StreamRateHz, bUseUDP);
+    }
+}
+
+void URemoteMCUChannel::StopStreaming(){
+    if(connection){
+        connection->StopStreaming();
+    }
+}
+
+void URemoteMCUChannel::ClearErr(){
+    if(connection){
+        connection->ClearErr();
+    }
+}
+
+ECLIErrorCodeBP URemoteMCUChannel::GetErr(){
+    return RemoteClientBP::FromCore(connection ? connection->GetErr() : ECLIErrorCode::NoServerConnection);
+}
+
+ECLIStatusCodeBP URemoteMCUChannel::GetStatus(){
+    return RemoteClientBP::FromCore(connection ? connection->GetStatus() : ECLIStatusCode::NO_SERVER_CONN);
+}
+
+FRemoteClientStatsInfoBP URemoteMCUChannel::GetStats(){
+    FRemoteClientStatsInfo info;
+    if(connection){
+        connection->GetStats().GetInfo(info);
+    }
+    return FRemoteClientStatsInfoBP(info);
+}
+
+void URemoteMCUChannel::ResetStats(){
+    if(connection){
+        connection->GetStats().Reset();
+    }
+}
@@ -4,9 +4,10 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
-#include "ServoInfo.h"
-#include "CLIErrorCode.h"
-#include "CLIStatusCode.h"
+#include "RemoteClientCore.h"
+#include "RemoteClientTypes.h"
+#include "RemoteClientConnection.h"
+#include "RemoteMCUChannel.h"
 #include "RemoteClientSystem.generated.h"
 
 /**
@@ -28,9 +29,108 @@ class REMOTECLIENTSYSTEM_API URemoteClientSystem : public UGameInstanceSubsystem
 		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
 		FString mcuName = "Maroon";
 
+		/** Shared memory skips the network stack when the server runs on this machine, its channel is named after Port. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
+		ERemoteClientTransportBP Transport = ERemoteClientTransportBP::Tcp;
+
+		/** Max movement orders awaiting MCU completion. 1 keeps the stop-and-wait SRVP flow, >1 sends sequenced SRVQ orders once the server confirmed it echoes their sequence (PROT). Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=1, ClampMax=16))
+		int32 MaxInFlightOrders = 1;
+
+		/** Offer the compact binary wire protocol on log-in, the text protocol is kept if the server refuses it. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
+		bool bUseBinaryProtocol = false;
+
+		/** Holds the first movement of a burst this long so the following ones go out in the same order. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=0, ClampMax=100000))
+		int32 CoalesceWindowUs = 0;
+
+		/** Tunes the coalescing window from the measured MCU ACK round trip, CoalesceWindowUs being the upper bound. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
+		bool bAdaptiveCoalescing = false;
+
+		/** Servo targets within this many degrees of the last position sent are not sent, 0 only drops repeats, -1 (default) sends everything so a target can be re-asserted. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=-1, ClampMax=179))
+		int32 Deadband = -1;
+
+		/**
+		 * Starts from the MCU info cached by the last session (Saved/RemoteClient/MCUInfo): movements are accepted right away &
+		 * sent as soon as the start up is over, its iMCU revalidates the cache. Applied on connect
+		 */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
+		bool bWarmStart = true;
+
+		/** Sends log-in, sMCU, iMCU & the binary offer in one go and matches the replies as they come: one round trip to start up. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
+		bool bPipelineHandshake = true;
+
+		/** Targets outside the servo limits (retrieved from the MCU after start up) are refused or clamped before they are sent. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
+		ERemoteClientLimitModeBP LimitMode = ERemoteClientLimitModeBP::Reject;
+
+		/** Setpoint rate of the real time streaming mode */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=1, ClampMax=1000))
+		float StreamRateHz = 100.f;
+
+		/** Rate at which trajectories are resampled into movement targets */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=1, ClampMax=1000))
+		float TrajectoryRateHz = 50.f;
+
+		/** Server port receiving setpoint datagrams when streaming over UDP. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
+		int32 StreamUdpPort = 54818;
+
+		/** Time allowed for the TCP connect. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=0.1))
+		float ConnectTimeoutS = 3.f;
+
+		/** Time allowed for a server reply (queries & server ACK) before the connection is dropped. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=0.1))
+		float ServerTimeoutS = 2.f;
+
+		/** Time allowed to the MCU to complete a movement after the server ACK. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=0.1))
+		float McuTimeoutS = 5.f;
+
+		/** Time allowed to a priority movement to be applied by the MCU, the connection is dropped past it. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=0.01))
+		float PriorityTimeoutS = 0.5f;
+
+		/** Reconnects with exponential backoff after a lost connection, restoring the selected MCU. Applied on connect */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config")
+		bool bAutoReconnect = true;
+
+		/** Upper bound of the reconnection backoff */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=0.25))
+		float ReconnectMaxDelayS = 10.f;
+
 		virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 		virtual void Deinitialize() override;
 
+		/**
+		 * Opens a channel to another MCU on the same server, with its own connection & servo state, so several boards are
+		 * driven concurrently. Returns the existing channel if one is open for that MCU. Uses the current config.
+		 */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		URemoteMCUChannel* OpenMCUChannel(const FString& MCU_Name);
+
+		/** Channel opened for MCU_Name, null if none */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		URemoteMCUChannel* GetMCUChannel(const FString& MCU_Name) const;
+
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void CloseMCUChannel(const FString& MCU_Name);
+
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		TArray<URemoteMCUChannel*> GetMCUChannels() const;
+
+		/** Channel of mcuName, driven by the functions below. Bind its events to be told when they complete */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		URemoteMCUChannel* GetPrimaryChannel() const { return primary; }
+
+		/** Movement handle of the primary channel for C++ callers on any thread, see FRemoteCommandChannel */
+		FRemoteCommandChannel GetCommandChannel() const { return primary ? primary->GetCommandChannel() : FRemoteCommandChannel(); }
+
 		UFUNCTION(BlueprintCallable, Category="Remote client system")
 		void ConnectToServer();
 
@@ -44,41 +144,109 @@ class REMOTECLIENTSYSTEM_API URemoteClientSystem : public UGameInstanceSubsystem
 		void RetrieveMCUInfo();
 
 		UFUNCTION(BlueprintCallable, Category="Remote client system")
-		TArray<FServoInfo> GetCurrentServoPositions();
+		TArray<FServoInfoBP> GetCurrentServoPositions();
 
 		TArray<uint8> _GetCurrentServoPositions();		
 
+		/** For BP polling: refills Positions (its allocation is reused) only if they changed since Version. Returns true if refilled */
 		UFUNCTION(BlueprintCallable, Category="Remote client system")
-		void SendMovement(TArray<FServoInfo> servoMovements);
+		bool UpdateCurrentServoPositions(UPARAM(ref) TArray<FServoInfoBP>& Positions, UPARAM(ref) int64& Version);
 
+		/** For C++ polling, lock-free & allocation free: refreshes the caller's snapshot only if the positions changed */
+		bool ReadServoPositions(FServoPositionSnapshot& InOutSnapshot) const;
+
+		/** Same as above into a caller buffer, positions in the range 1-180. Returns the servo count written, -1 if unchanged since InOutVersion */
+		int32 ReadServoPositions(TArrayView<uint8> OutPositions, uint64& InOutVersion) const;
+
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void SendMovement(const TArray<FServoInfoBP>& servoMovements);
+
+		/**
+		 * Urgent movement: skips the queued movements & goes out right away, the server hands it to the MCU first.
+		 * bCancelPending drops what was queued before it. Bind OnPriorityMovementCompleted of the primary channel
+		 */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void SendPriorityMovement(TArray<FServoInfoBP> servoMovements, bool bCancelPending);
+
+		/** Joint angle -> servo position calibration of ServoID, used by SendPose */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void SetServoCalibration(int32 ServoID, const FServoCalibrationBP& Calibration);
+
+		/** Sends a joint angle pose (degrees, index = servo), only the servos whose calibrated position changed go out */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void SendPose(const TArray<float>& JointAnglesDeg);
+
+		/** Safety stop: every servo holds its current position, queued movements & the trajectory are cancelled */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void HoldPosition();
+
+		/**
+		 * Plays time-stamped keyframes for any subset of servos, interpolated & resampled at TrajectoryRateHz off the game thread.
+		 * Replaces the trajectory of the servos in the batch, or starts after the playing trajectory ends if bAppend.
+		 */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void PlayTrajectory(const TArray<FServoKeyframeBP>& Keyframes, ETrajectoryInterpolationBP Interpolation, bool bAppend);
+
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void StopTrajectory();
+
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		bool IsTrajectoryPlaying();
+
+		/** Server pushes the measured servo positions at RateHz (0 stops), bind OnServoPositionsChanged of the primary channel */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void SubscribeTelemetry(float RateHz);
+
+		/**
+		 * Records the command stream of the primary channel (movement frames sent, ACK/NACK/iMCU received, timestamped)
+		 * into an append-only binary log. FilePath is absolute or relative to Saved/RemoteClient
+		 */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		bool StartRecording(const FString& FilePath);
+
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void StopRecording();
+
+		/** Streams the movements of a recorded log back through the primary channel, at Speed x or as fast as possible (0) */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		bool StartReplay(const FString& FilePath, float Speed = 1.f);
+
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void StopReplay();
+
+		/** Switches the server to real time mode: SendMovement targets are then streamed at StreamRateHz, without per-order MCU ACKs */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void StartStreaming(bool bUseUDP);
+
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void StopStreaming();
+
+		/** Applied by the connection thread in order with the failures, movements sent before it lands are still refused */
 		UFUNCTION(BlueprintCallable, Category="Remote client system")
 		void ClearErr();
 
 		UFUNCTION(BlueprintCallable, Category="Remote client system")
-		ECLIErrorCode GetErr();
+		ECLIErrorCodeBP GetErr();
 
-	private:
-	
-		FSocket* sck;
-		FCriticalSection MTX_statusCheck;
-		FCriticalSection MTX_pendingMovements;
-		FCriticalSection MTX_currentPositions;
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		ECLIStatusCodeBP GetStatus();
 
-		std::atomic<bool> err = false;
-		std::atomic<ECLIErrorCode> errCode = ECLIErrorCode::CLEAR;
+		/** Per-phase latencies (enqueue, server ACK, MCU ACK, startup) & counters since the last ResetStats */
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		FRemoteClientStatsInfoBP GetStats();
 
-		std::atomic<ECLIStatusCode> status = ECLIStatusCode::STARTING_UP;
+		UFUNCTION(BlueprintCallable, Category="Remote client system")
+		void ResetStats();
 
-		std::atomic<bool> PENDING_MOVEMENT = false;
-		TArray<uint8> pendingMovements;
+	private:
 
-		TArray<uint8> currentServoPositions;
-		uint8 servoCount=0;
+		/* Channel of mcuName, switched with SelectMCU */
+		UPROPERTY()
+		TObjectPtr<URemoteMCUChannel> primary;
 
-		bool _is_ACK(const TArray<uint8>& query);
-		bool _is_NACK(const TArray<uint8>& query);
-		bool _is_iMCU(const TArray<uint8>& query);
-		void _CloseConnection();
-};
+		/* Additional channels, by MCU name */
+		UPROPERTY()
+		TMap<FString, TObjectPtr<URemoteMCUChannel>> channels;
 
-DECLARE_LOG_CATEGORY_EXTERN(LogRemoteClientSystem, Log, All);
\ No newline at end of file
+		FRemoteClientSettings _MakeSettings() const;
+};
\ No newline at end of file
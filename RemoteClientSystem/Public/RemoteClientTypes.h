@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ServoInfo.h"
+#include "CLIErrorCode.h"
+#include "CLIStatusCode.h"
+#include "RemoteClientTransport.h"
+#include "ServoStateTable.h"
+#include "ServoTrajectory.h"
+#include "RemoteClientStats.h"
+#include "ServoPose.h"
+#include "RemoteClientTypes.generated.h"
+
+/*
+ * Blueprint types of the subsystem & its channels. The RemoteClientCore value types are plain C++ so the core builds
+ * without CoreUObject, these wrap them & are converted at the UObject boundary. C++ callers use the core types.
+ */
+
+/**
+ * Enum with the different Error codes the Remote Client System might take, see ECLIErrorCode
+ */
+UENUM(BlueprintType, meta=(DisplayName="CLI Error Code"))
+enum class ECLIErrorCodeBP : uint8
+{
+	CLEAR 						=0 	 UMETA(DisplayName = "No Error"),
+	GenericError 				=1 	 UMETA(DisplayName = "Generic Error"),
+    ServerConnError             =2   UMETA(DisplayName = "Server Connection Error"),
+    CorruptedICMU               =3   UMETA(DisplayName = "Information from server (iMCU) was corrupted"),
+    NoServerConnection          =4   UMETA(DisplayName = "No active server connection"),
+    ConnectTimeout              =5   UMETA(DisplayName = "Server connection timed out"),
+    ServerTimeout               =6   UMETA(DisplayName = "Server did not answer in time"),
+    MCUTimeout                  =7   UMETA(DisplayName = "MCU did not complete the movement in time"),
+    StaleMCUInfo                =8   UMETA(DisplayName = "Cached MCU info did not match the MCU"),
+    Preempted                   =9   UMETA(DisplayName = "Movement cancelled by a priority movement"),
+    PriorityTimeout             =10  UMETA(DisplayName = "Priority movement not confirmed in time"),
+
+	INVALID_SERVO_ID	   		=100 UMETA(DisplayName = "ServoID out of range"),
+	INVALID_SERVO_POSITION 		=101 UMETA(DisplayName = "ServoPosition out of range"),
+
+	NACK_InvalidQuery			=255 UMETA(DisplayName = "Server NACK - Invalid Query"),
+    NACK_NoActiveMCU			=254 UMETA(DisplayName = "Server NACK - No Active MCU"),
+    NACK_OnRTMode			    =253 UMETA(DisplayName = "Server NACK - On Real Time mode"),
+    NACK_InvalidParameter		=252 UMETA(DisplayName = "Server NACK - Invalid Parameter"),
+    NACK_ServoCountMismatch		=251 UMETA(DisplayName = "Server NACK - Servo Count Mismatch"),
+    NACK_NoMCUInfo				=250 UMETA(DisplayName = "Server NACK - No MCU Info"),
+    NACK_MCUOffline				=249 UMETA(DisplayName = "Server NACK - MCU Offline"),
+    NACK_ErrorContactingMCU		=248 UMETA(DisplayName = "Server NACK - Error Contacting MCU"),
+    NACK_ErrorLoadingMINMAX		=247 UMETA(DisplayName = "Server NACK - Error loading Min-Max information")
+};
+
+/**
+ * Enum with the different Client status codes the Remote Client System might take, see ECLIStatusCode
+ */
+UENUM(BlueprintType, meta=(DisplayName="CLI Status Code"))
+enum class ECLIStatusCodeBP : uint8
+{
+	IDLE 						=0   UMETA(DisplayName = "Idle"),
+	WAITING_SERVER_ACK			=1   UMETA(DisplayName = "Waiting for server confirmation"),
+	WAITING_MCU_ACK				=2   UMETA(DisplayName = "Waiting for movement completion"),
+	STREAMING					=3   UMETA(DisplayName = "Streaming setpoints (real time mode)"),
+	SWITCHING_RT_MODE			=4   UMETA(DisplayName = "Waiting for real time mode switch"),
+	SWITCHING_TELEMETRY			=5   UMETA(DisplayName = "Waiting for telemetry subscription"),
+	RETRIEVING_LIMITS			=248 UMETA(DisplayName = "Processing lMCU query"),
+	CONNECTING					=249 UMETA(DisplayName = "Connecting to server"),
+	NEGOTIATING_PROTOCOL		=250 UMETA(DisplayName = "Negotiating wire protocol"),
+	NO_SERVER_CONN				=251 UMETA(DisplayName = "No server connection available"),
+	RETRIEVING_INFO				=252 UMETA(DisplayName = "Processing iMCU query"),
+	RETRIEVING_INFO_sMCU		=253 UMETA(DisplayName = "Processing iMCU query"),
+	ON_MCU_SELECT				=254 UMETA(DisplayName = "Processing sMCU query"),
+	STARTING_UP					=255 UMETA(DisplayName = "Client Starting up")
+};
+
+/**
+ * Byte stream carrying the protocol frames between the client and the server, see ERemoteClientTransport
+ */
+UENUM(BlueprintType, meta=(DisplayName="Remote Client Transport"))
+enum class ERemoteClientTransportBP : uint8
+{
+	Tcp				=0	UMETA(DisplayName = "TCP socket"),
+	SharedMemory	=1	UMETA(DisplayName = "Shared memory (server on the same machine)")
+};
+
+/**
+ * How targets outside a servo's limits are handled before anything goes on the wire, see ERemoteClientLimitMode
+ */
+UENUM(BlueprintType, meta=(DisplayName="Remote Client Limit Mode"))
+enum class ERemoteClientLimitModeBP : uint8
+{
+	Reject		=0	UMETA(DisplayName = "Reject the movement"),
+	Clamp		=1	UMETA(DisplayName = "Clamp to the limits"),
+	Off			=2	UMETA(DisplayName = "Off (full range only)")
+};
+
+/**
+ * Interpolation between the keyframes of a servo trajectory, see ETrajectoryInterpolation
+ */
+UENUM(BlueprintType, meta=(DisplayName="Trajectory Interpolation"))
+enum class ETrajectoryInterpolationBP : uint8
+{
+	Linear		=0	UMETA(DisplayName = "Linear"),
+	Cubic		=1	UMETA(DisplayName = "Cubic (eases in & out of the first & last keyframes)")
+};
+
+/**
+ * Struct used to store the information pair (servo id,servo position), see FServoInfo
+ */
+USTRUCT(BlueprintType, meta=(DisplayName="Servo Info"))
+struct FServoInfoBP
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Information Struct", meta=(ClampMin=0, ClampMax=31))
+    uint8 servoID = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Information Struct", meta=(ClampMin=0, ClampMax=179))
+    uint8 servoPosition = 0;
+
+    FServoInfoBP(){}
+
+    explicit FServoInfoBP(const FServoInfo& Info): servoID(Info.servoID), servoPosition(Info.servoPosition){}
+
+    FServoInfo ToCore() const { return FServoInfo(servoID, servoPosition); }
+};
+
+/**
+ * Time-stamped target of one servo, time in seconds from the start of the trajectory batch, see FServoKeyframe
+ */
+USTRUCT(BlueprintType, meta=(DisplayName="Servo Keyframe"))
+struct FServoKeyframeBP
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Keyframe Struct", meta=(ClampMin=0))
+    float time = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Keyframe Struct", meta=(ClampMin=0, ClampMax=31))
+    uint8 servoID = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Keyframe Struct", meta=(ClampMin=0, ClampMax=179))
+    uint8 servoPosition = 0;
+
+    FServoKeyframe ToCore() const { return FServoKeyframe(time, servoID, servoPosition); }
+};
+
+/**
+ * Latency percentiles of one phase, in milliseconds, see FRemoteClientLatencyInfo
+ */
+USTRUCT(BlueprintType, meta=(DisplayName="Remote Client Latency Info"))
+struct FRemoteClientLatencyInfoBP
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    int64 Count = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    float MeanMs = 0.f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    float P50Ms = 0.f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    float P90Ms = 0.f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    float P99Ms = 0.f;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    float MaxMs = 0.f;
+
+    FRemoteClientLatencyInfoBP(){}
+
+    explicit FRemoteClientLatencyInfoBP(const FRemoteClientLatencyInfo& Info):
+        Count(Info.Count), MeanMs(Info.MeanMs), P50Ms(Info.P50Ms), P90Ms(Info.P90Ms), P99Ms(Info.P99Ms), MaxMs(Info.MaxMs){}
+};
+
+/**
+ * Stats of the remote client since the last reset, see FRemoteClientStatsInfo for the phases
+ */
+USTRUCT(BlueprintType, meta=(DisplayName="Remote Client Stats Info"))
+struct FRemoteClientStatsInfoBP
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP Queue;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP ServerAck;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP McuAck;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP Order;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP Connect;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP SelectMCU;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP MCUInfo;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP Startup;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    FRemoteClientLatencyInfoBP Priority;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    int64 OrdersSent = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    int64 OrdersCompleted = 0;
+
+    /** Completed orders per second, averaged since the last reset */
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    float OrdersPerSecond = 0.f;
+
+    /** Servo targets written by SendMovement */
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    int64 ServoWrites = 0;
+
+    /** Servo targets overwritten by a later SendMovement before they were sent */
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    int64 CoalescedWrites = 0;
+
+    /** Servo targets dropped because they were within the deadband of the last commanded position */
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    int64 DeadbandDrops = 0;
+
+    UPROPERTY(BlueprintReadOnly, Category = "Remote Client Stats")
+    TMap<ECLIErrorCodeBP, int64> NacksByCode;
+
+    FRemoteClientStatsInfoBP(){}
+
+    explicit FRemoteClientStatsInfoBP(const FRemoteClientStatsInfo& Info);
+};
+
+/**
+ * Joint angle -> servo position mapping of one servo, see FServoCalibration
+ */
+USTRUCT(BlueprintType, meta=(DisplayName="Servo Calibration"))
+struct FServoCalibrationBP
+{
+    GENERATED_BODY()
+
+public:
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Calibration Struct")
+    float offset = 0.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Calibration Struct")
+    float scale = 1.f;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Calibration Struct")
+    bool bInvert = false;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Calibration Struct", meta=(ClampMin=0, ClampMax=179))
+    uint8 minPosition = 0;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Servo Calibration Struct", meta=(ClampMin=0, ClampMax=179))
+    uint8 maxPosition = 179;
+
+    FServoCalibration ToCore() const;
+};
+
+/** Conversions between the Blueprint & core types, the enums share their values */
+namespace RemoteClientBP
+{
+	REMOTECLIENTSYSTEM_API ECLIErrorCodeBP FromCore(ECLIErrorCode Code);
+	REMOTECLIENTSYSTEM_API ECLIStatusCodeBP FromCore(ECLIStatusCode Code);
+	REMOTECLIENTSYSTEM_API ERemoteClientTransport ToCore(ERemoteClientTransportBP Transport);
+	REMOTECLIENTSYSTEM_API ERemoteClientLimitMode ToCore(ERemoteClientLimitModeBP LimitMode);
+	REMOTECLIENTSYSTEM_API ETrajectoryInterpolation ToCore(ETrajectoryInterpolationBP Interpolation);
+
+	/** Out is reset, its allocation is kept */
+	REMOTECLIENTSYSTEM_API void ToCore(TArrayView<const FServoInfoBP> Servos, TArray<FServoInfo>& Out);
+	REMOTECLIENTSYSTEM_API void ToCore(TArrayView<const FServoKeyframeBP> Keyframes, TArray<FServoKeyframe>& Out);
+}
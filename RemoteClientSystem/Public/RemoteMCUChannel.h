@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "RemoteClientTypes.h"
+#include "RemoteClientConnection.h"
+#include "RemoteClientLog.h"
+#include "RemoteCommandChannel.h"
+#include "ServoPose.h"
+#include "RemoteMCUChannel.generated.h"
+
+/** Completion of a channel operation: CLEAR or the error/NACK code that ended it. Always broadcast on the game thread */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FRemoteClientResultDelegate, ECLIErrorCodeBP, Result);
+
+/** Servos moved according to telemetry, with their new positions (0-179) */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FServoPositionsChangedDelegate, const TArray<FServoInfoBP>&, MovedServos);
+
+/**
+ * Control channel of one MCU: its own server connection (own thread, socket, servo state & in-flight orders).
+ * The server binds the MCU selected with sMCU to the connection, so boards driven through separate channels run concurrently
+ * and are never switched with sMCU/iMCU round trips. Channels are opened & looked up by MCU name on URemoteClientSystem.
+ */
+UCLASS(BlueprintType)
+class REMOTECLIENTSYSTEM_API URemoteMCUChannel : public UObject
+{
+	GENERATED_BODY()
+
+	public:
+
+		/** Setpoint rate of the real time streaming mode */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=1, ClampMax=1000))
+		float StreamRateHz = 100.f;
+
+		/** Rate at which trajectories are resampled into movement targets */
+		UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Config", meta=(ClampMin=1, ClampMax=1000))
+		float TrajectoryRateHz = 50.f;
+
+		/** Connect & Reconnect done: logged in, MCU selected & retrieved */
+		UPROPERTY(BlueprintAssignable, Category="Remote MCU channel")
+		FRemoteClientResultDelegate OnConnected;
+
+		/** SelectMCU done: new MCU selected & retrieved */
+		UPROPERTY(BlueprintAssignable, Category="Remote MCU channel")
+		FRemoteClientResultDelegate OnMCUSelected;
+
+		UPROPERTY(BlueprintAssignable, Category="Remote MCU channel")
+		FRemoteClientResultDelegate OnMCUInfoRetrieved;
+
+		/** Movement completed by the MCU. Movements are only tracked while this event is bound */
+		UPROPERTY(BlueprintAssignable, Category="Remote MCU channel")
+		FRemoteClientResultDelegate OnMovementCompleted;
+
+		/** Priority movement (or HoldPosition) applied by the MCU, or the code that refused it */
+		UPROPERTY(BlueprintAssignable, Category="Remote MCU channel")
+		FRemoteClientResultDelegate OnPriorityMovementCompleted;
+
+		/** SubscribeTelemetry acknowledged by the server (TLMS), or the code that refused it */
+		UPROPERTY(BlueprintAssignable, Category="Remote MCU channel")
+		FRemoteClientResultDelegate OnTelemetrySubscribed;
+
+		/** Telemetry moved some servos, see SubscribeTelemetry. Moves arriving before the game thread catches up are merged */
+		UPROPERTY(BlueprintAssignable, Category="Remote MCU channel")
+		FServoPositionsChangedDelegate OnServoPositionsChanged;
+
+		/** Starts the connection thread & connects, the MCU of Settings is selected & retrieved on log-in */
+		TFuture<ECLIErrorCode> Connect(const FRemoteClientSettings& Settings);
+		void Close();
+
+		FRemoteClientConnection& GetConnection() { return *connection; }
+		const FRemoteClientSettings& GetSettings() const { return settings; }
+
+		/** Movement handle for any thread, bypasses the events below. Invalid until Connect, refused once closed */
+		FRemoteCommandChannel GetCommandChannel() const { return FRemoteCommandChannel(connection); }
+
+		/** Switches this channel to another MCU (sMCU + iMCU), used by the subsystem's own channel */
+		TFuture<ECLIErrorCode> SelectMCU(const FString& MCU_Name);
+
+		/* C++ counterparts of the functions below, the events are broadcast as well */
+		TFuture<ECLIErrorCode> RetrieveMCUInfoAsync();
+		TFuture<ECLIErrorCode> SendMovementAsync(TArrayView<const FServoInfo> servoMovements);
+		TFuture<ECLIErrorCode> SendPriorityMovementAsync(TArrayView<const FServoInfo> servoMovements, bool bCancelPending);
+		TFuture<ECLIErrorCode> HoldPositionAsync();
+		TFuture<ECLIErrorCode> SubscribeTelemetryAsync(float RateHz);
+
+		/** Connects again with the settings of the last Connect */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void Reconnect();
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void Disconnect();
+
+		UFUNCTION(BlueprintPure, Category="Remote MCU channel")
+		FString GetMCUName() const { return settings.mcuName; }
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void RetrieveMCUInfo();
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		TArray<FServoInfoBP> GetCurrentServoPositions();
+
+		/** For BP polling: refills Positions (its allocation is reused) only if they changed since Version. Returns true if refilled */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		bool UpdateCurrentServoPositions(UPARAM(ref) TArray<FServoInfoBP>& Positions, UPARAM(ref) int64& Version);
+
+		/** For C++ polling, lock-free & allocation free: refreshes the caller's snapshot only if the positions changed */
+		bool ReadServoPositions(FServoPositionSnapshot& InOutSnapshot) const;
+
+		/** Same as above into a caller buffer, positions in the range 1-180. Returns the servo count written, -1 if unchanged since InOutVersion */
+		int32 ReadServoPositions(TArrayView<uint8> OutPositions, uint64& InOutVersion) const;
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void SendMovement(const TArray<FServoInfoBP>& servoMovements);
+
+		/**
+		 * Sent ahead of the queued movements on a lane of its own, accepted in error state too. bCancelPending drops the
+		 * movements & trajectory not completed yet. See OnPriorityMovementCompleted
+		 */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void SendPriorityMovement(const TArray<FServoInfoBP>& servoMovements, bool bCancelPending);
+
+		/** Range (0-179) the movements of ServoID are checked or clamped against, see LimitMode. False for an invalid servo */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		bool GetServoLimits(int32 ServoID, int32& OutMin, int32& OutMax) const;
+
+		/** False while the server has not reported the MCU limits: servers without lMCU leave only the full range & the user limits */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		bool HasMCULimits() const;
+
+		/** Calibration SendPose maps the joint angle of ServoID (0-31) with */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void SetServoCalibration(int32 ServoID, const FServoCalibrationBP& Calibration);
+
+		/**
+		 * Sends a joint angle pose in degrees, servo i taking JointAnglesDeg[i]: converted with the servo calibrations &
+		 * only the servos whose position changed go out. Meant to run every frame, not tracked by OnMovementCompleted
+		 */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void SendPose(const TArray<float>& JointAnglesDeg);
+
+		/** Copy it to convert poses on another thread, see FRemoteCommandChannel::SendPose */
+		const FServoPoseConverter& GetPoseConverter() const { return poseConverter; }
+
+		/** Stops every servo where it is, cancelling the queued movements & the trajectory */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void HoldPosition();
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void PlayTrajectory(const TArray<FServoKeyframeBP>& Keyframes, ETrajectoryInterpolationBP Interpolation, bool bAppend);
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void StopTrajectory();
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		bool IsTrajectoryPlaying();
+
+		/** Server pushes the measured positions at RateHz (0 stops) into the current positions, see OnTelemetrySubscribed & OnServoPositionsChanged */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void SubscribeTelemetry(float RateHz);
+
+		/**
+		 * Records the movement frames sent & the ACK/NACK/iMCU replies into a binary log, see FRemoteClientRecorder.
+		 * FilePath is absolute or relative to Saved/RemoteClient. Returns false if the log could not be created
+		 */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		bool StartRecording(const FString& FilePath);
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void StopRecording();
+
+		/** Sends the movements of a log again, at Speed times the recorded pace or as fast as the connection takes them (0) */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		bool StartReplay(const FString& FilePath, float Speed = 1.f);
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void StopReplay();
+
+		UFUNCTION(BlueprintPure, Category="Remote MCU channel")
+		bool IsReplaying() const { return replayer && replayer->IsRunning(); }
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void StartStreaming(bool bUseUDP);
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void StopStreaming();
+
+		/** Applied by the connection thread in order with the failures, movements sent before it lands are still refused */
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void ClearErr();
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		ECLIErrorCodeBP GetErr();
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		ECLIStatusCodeBP GetStatus();
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		FRemoteClientStatsInfoBP GetStats();
+
+		UFUNCTION(BlueprintCallable, Category="Remote MCU channel")
+		void ResetStats();
+
+		virtual void BeginDestroy() override;
+
+	private:
+
+		/* Owns the socket & the connection thread of this MCU, command channels only hold weak references */
+		TSharedPtr<FRemoteClientConnection, ESPMode::ThreadSafe> connection;
+		FRemoteClientSettings settings;
+		TSharedPtr<FRemoteClientRecorder, ESPMode::ThreadSafe> recorder;
+		TUniquePtr<FRemoteClientReplayer> replayer;     /* Reads the connection, goes first */
+
+		static FString _LogPath(const FString& FilePath);
+
+		/** Broadcasts Event on the game thread once Result is fulfilled, passes the result on */
+		TFuture<ECLIErrorCode> _Notify(TFuture<ECLIErrorCode>&& Result, FRemoteClientResultDelegate URemoteMCUChannel::* Event);
+
+		/* Game thread */
+		TArray<FServoInfoBP> movedServos;
+		TArray<FServoInfo> coreServos;      /* BP movements converted for the connection, keeps the allocation */
+		FServoPoseConverter poseConverter;
+		void _BroadcastMovedServos();
+};